@@ -3,9 +3,10 @@ import bb.cascades 1.0
 Page {
     id: page
     property int contactId
-    property alias photoImageSource: photoView.imageSource
+    property alias photoImage: photoView.image
     property alias displayName: displayNameLabel.text
     property alias displayCompanyName: displayCompanyLabel.text
+    property alias loading: activityIndicator.running
     
     signal propertiesSelected()
     signal attributesSelected()
@@ -107,11 +108,18 @@ Page {
                             title: ListItemData.title
                             description: ListItemData.description
                             status: ListItemData.status
-                            imageSource: ListItemData.imageSource
+                            image: ListItemData.image
                         }
                     }
                 ]
             }
         }
+        ActivityIndicator {
+            id: activityIndicator
+            verticalAlignment: VerticalAlignment.Center
+            horizontalAlignment: HorizontalAlignment.Center
+            preferredHeight: 200
+            preferredWidth: 200
+        }
     }
 }
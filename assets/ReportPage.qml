@@ -0,0 +1,60 @@
+import bb.cascades 1.0
+
+Page {
+    id: page
+    property alias reportTitle: titleBar.title
+    property alias summary: summaryLabel.text
+    // Titles of the headers, for models grouped by something other than text
+    property variant groupTitles: ({})
+
+    signal openContact(int contactId)
+
+    titleBar: TitleBar {
+        id: titleBar
+    }
+
+    content: Container {
+        horizontalAlignment: HorizontalAlignment.Fill
+
+        Label {
+            id: summaryLabel
+            horizontalAlignment: HorizontalAlignment.Fill
+            leftMargin: 20
+            rightMargin: 20
+            multiline: true
+            textFormat: TextFormat.Plain
+        }
+
+        ListView {
+            objectName: "listView"
+            function groupTitle(group) {
+                var title = page.groupTitles[group];
+                return (title !== undefined) ? title : group;
+            }
+            listItemComponents: [
+                ListItemComponent {
+                    type: "header"
+                    Header {
+                        title: ListItem.view.groupTitle(ListItemData)
+                    }
+                },
+                ListItemComponent {
+                    type: "item"
+                    StandardListItem {
+                        title: ListItemData.title
+                        description: ListItemData.description
+                        status: ListItemData.status
+                    }
+                }
+            ]
+            onTriggered: {
+                if (indexPath.length > 1) {
+                    var chosenItem = dataModel.data(indexPath);
+                    if (chosenItem.contactId) {
+                        page.openContact(chosenItem.contactId);
+                    }
+                }
+            }
+        }
+    }
+}
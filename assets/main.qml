@@ -1,4 +1,5 @@
 import bb.cascades 1.0
+import org.logicprobe.ContactsInspector 1.0
 
 NavigationPane {
     id: nav
@@ -8,40 +9,75 @@ NavigationPane {
         signal refreshList()
         signal search()
         signal openContact(int contactId)
+        signal contactActivated(int contactId)
+        signal filterChanged(string text)
+        signal exportAll()
+        signal exportBinary()
+        signal findDuplicates()
+        signal showStatistics()
+        signal compareExports()
+        signal openDump()
+        signal closeDump()
         property string appName: "Contacts Inspector"
+        property bool filterActive: false
+        property bool offline: false
         property alias activityRunning: activityIndicator.running
+        property alias activityText: activityLabel.text
 
         titleBar: TitleBar {
-            title: page.appName
+            title: page.offline ? qsTr("%1 (Offline)").arg(page.appName) : page.appName
         }
         
         content: Container {
             layout: DockLayout { }
-            ListView {
-                objectName: "listView"
+            Container {
                 verticalAlignment: VerticalAlignment.Fill
                 horizontalAlignment: HorizontalAlignment.Fill
-                dataModel: GroupDataModel {
-                    objectName: "dataModel"
-                    grouping: ItemGrouping.ByFirstChar
-                    sortingKeys: ["displayName"]
+                TextField {
+                    id: filterField
+                    visible: page.filterActive
+                    hintText: qsTr("Filter contacts") + Retranslate.onLanguageChanged
+                    inputMode: TextFieldInputMode.Text
+                    onTextChanging: {
+                        page.filterChanged(text)
+                    }
                 }
-                listItemComponents: [
-                    ListItemComponent {
-                        type: "item"
-                        StandardListItem {
-                            title: ListItemData.displayName
-                            description: ListItemData.displayCompanyName
-                            status: ListItemData.contactId
-                            imageSource: ListItemData.photo
-                            imageSpaceReserved: true
+                ListView {
+                    objectName: "listView"
+                    verticalAlignment: VerticalAlignment.Fill
+                    horizontalAlignment: HorizontalAlignment.Fill
+                    dataModel: ContactListModel {
+                        objectName: "dataModel"
+                    }
+                    listItemComponents: [
+                        ListItemComponent {
+                            type: "header"
+                            Header {
+                                title: ListItemData
+                            }
+                        },
+                        ListItemComponent {
+                            type: "item"
+                            StandardListItem {
+                                title: ListItemData.displayName
+                                description: ListItemData.displayCompanyName
+                                status: ListItemData.contactId
+                                image: ListItemData.image
+                                imageSpaceReserved: true
+                            }
+                        }
+                    ]
+                    onTriggered: {
+                        if (indexPath.length > 1) {
+                            var chosenItem = dataModel.data(indexPath);
+                            page.openContact(chosenItem.contactId);
                         }
                     }
-                ]
-                onTriggered: {
-                    if (indexPath.length > 1) {
-                        var chosenItem = dataModel.data(indexPath);
-                        page.openContact(chosenItem.contactId);
+                    onActivationChanged: {
+                        if (active && indexPath.length > 1) {
+                            var activeItem = dataModel.data(indexPath);
+                            page.contactActivated(activeItem.contactId);
+                        }
                     }
                 }
             }
@@ -60,6 +96,16 @@ NavigationPane {
                     preferredHeight: 400
                     preferredWidth: 400
                 }
+                Label {
+                    id: activityLabel
+                    verticalAlignment: VerticalAlignment.Bottom
+                    horizontalAlignment: HorizontalAlignment.Center
+                    visible: text.length > 0
+                    textStyle {
+                        base: SystemDefaults.TextStyles.TitleText
+                        color: Color.White
+                    }
+                }
             }
         }
         actions: [
@@ -80,6 +126,80 @@ NavigationPane {
                 onTriggered: {
                     page.search()
                 }
+            },
+            ActionItem {
+                enabled: !page.activityRunning
+                title: (page.filterActive ? qsTr("Close Filter") : qsTr("Filter")) + Retranslate.onLanguageChanged
+                imageSource: "asset:///images/ic_search.png"
+                ActionBar.placement: ActionBarPlacement.InOverflow
+                onTriggered: {
+                    page.filterActive = !page.filterActive
+                    if (page.filterActive) {
+                        filterField.requestFocus()
+                    } else {
+                        filterField.text = ""
+                        page.filterChanged("")
+                    }
+                }
+            },
+            ActionItem {
+                enabled: !page.activityRunning
+                title: qsTr("Export All") + Retranslate.onLanguageChanged
+                imageSource: "asset:///images/ic_save.png"
+                ActionBar.placement: ActionBarPlacement.InOverflow
+                onTriggered: {
+                    page.exportAll()
+                }
+            },
+            ActionItem {
+                enabled: !page.activityRunning
+                title: qsTr("Export All (Binary)") + Retranslate.onLanguageChanged
+                imageSource: "asset:///images/ic_save.png"
+                ActionBar.placement: ActionBarPlacement.InOverflow
+                onTriggered: {
+                    page.exportBinary()
+                }
+            },
+            ActionItem {
+                enabled: !page.activityRunning
+                title: qsTr("Find Duplicates") + Retranslate.onLanguageChanged
+                imageSource: "asset:///images/ic_search.png"
+                ActionBar.placement: ActionBarPlacement.InOverflow
+                onTriggered: {
+                    page.findDuplicates()
+                }
+            },
+            ActionItem {
+                enabled: !page.activityRunning
+                title: qsTr("Statistics") + Retranslate.onLanguageChanged
+                imageSource: "asset:///images/ic_info.png"
+                ActionBar.placement: ActionBarPlacement.InOverflow
+                onTriggered: {
+                    page.showStatistics()
+                }
+            },
+            ActionItem {
+                enabled: !page.activityRunning
+                title: qsTr("Compare Exports") + Retranslate.onLanguageChanged
+                imageSource: "asset:///images/ic_info.png"
+                ActionBar.placement: ActionBarPlacement.InOverflow
+                onTriggered: {
+                    page.compareExports()
+                }
+            },
+            ActionItem {
+                enabled: !page.activityRunning
+                title: (page.offline ? qsTr("Close Dump") : qsTr("Open Dump")) + Retranslate.onLanguageChanged
+                imageSource: "asset:///images/ic_info.png"
+                ActionBar.placement: ActionBarPlacement.InOverflow
+                onTriggered: {
+                    if(page.offline) {
+                        page.closeDump()
+                    }
+                    else {
+                        page.openDump()
+                    }
+                }
             }
         ]
     }
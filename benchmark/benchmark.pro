@@ -0,0 +1,13 @@
+# Headless benchmark of the contact loading, search and detail code, run
+# against generated contacts. Builds with a desktop Qt 4.8:
+#   qmake benchmark.pro && make && ./benchmark --contacts 100000
+
+TEMPLATE = app
+TARGET = benchmark
+QT = core
+CONFIG += console warn_on release
+CONFIG -= app_bundle
+
+include(../src/portable.pri)
+
+SOURCES += main.cpp
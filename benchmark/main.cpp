@@ -0,0 +1,261 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QEventLoop>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QBuffer>
+#include <QtCore/QtAlgorithms>
+
+#include <stdio.h>
+
+#include "contactsloader.hpp"
+#include "contactsearchindex.hpp"
+#include "contactdetails.hpp"
+#include "contactexporter.hpp"
+#include "binaryexport.hpp"
+#include "jsonwriter.hpp"
+#include "syntheticcontactsource.hpp"
+
+namespace
+{
+struct BenchmarkOptions
+{
+    BenchmarkOptions() : searchCount(1000), detailsCount(200), partitioned(false) { }
+    SyntheticContactOptions source;
+    int searchCount;
+    int detailsCount;
+    bool partitioned;
+};
+
+/**
+ * Stands in for the UI thread, consuming pages the way the contact list
+ * does.
+ */
+class PageReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    PageReceiver(ContactsLoader *loader, ContactSearchIndex *index)
+        : loader_(loader), index_(index), firstPageMsecs_(-1), contactCount_(0)
+    {
+        timer_.start();
+    }
+    qint64 firstPageMsecs() const { return firstPageMsecs_; }
+    int contactCount() const { return contactCount_; }
+public slots:
+    void onPageLoaded(int generation, const ContactListPage &page)
+    {
+        Q_UNUSED(generation);
+        if(firstPageMsecs_ < 0) {
+            firstPageMsecs_ = timer_.elapsed();
+        }
+        QElapsedTimer timer;
+        timer.start();
+        foreach(const ContactListEntry &entry, *page) {
+            index_->add(entry.contactId, entry.displayName, entry.displayCompanyName);
+        }
+        contactCount_ += page->size();
+        loader_->pageConsumed(page->size(), timer.elapsed());
+    }
+private:
+    ContactsLoader *loader_;
+    ContactSearchIndex *index_;
+    QElapsedTimer timer_;
+    qint64 firstPageMsecs_;
+    int contactCount_;
+};
+
+void report(const char *name, double value, const char *unit)
+{
+    printf("%-28s %14.3f %s\n", name, value, unit);
+}
+
+void reportTimes(const char *name, QVector<qint64> nsecs)
+{
+    if(nsecs.isEmpty()) { return; }
+    qSort(nsecs);
+    qint64 total = 0;
+    foreach(qint64 value, nsecs) {
+        total += value;
+    }
+    const QByteArray prefix(name);
+    report((prefix + ".mean").constData(), total / 1000.0 / nsecs.size(), "us");
+    report((prefix + ".p50").constData(), nsecs[nsecs.size() / 2] / 1000.0, "us");
+    report((prefix + ".p95").constData(), nsecs[nsecs.size() * 95 / 100] / 1000.0, "us");
+    report((prefix + ".max").constData(), nsecs.last() / 1000.0, "us");
+}
+
+qint64 peakMemoryKilobytes()
+{
+    QFile file(QLatin1String("/proc/self/status"));
+    if(!file.open(QIODevice::ReadOnly)) { return -1; }
+    foreach(const QByteArray &line, file.readAll().split('\n')) {
+        if(line.startsWith("VmHWM:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return -1;
+}
+
+bool parseArguments(const QStringList &arguments, BenchmarkOptions *options)
+{
+    for(int i = 1; i < arguments.size(); i++) {
+        const QString &name = arguments[i];
+        if(name == QLatin1String("--partitioned")) {
+            options->partitioned = true;
+            continue;
+        }
+        if(name == QLatin1String("--help") || i + 1 >= arguments.size()) {
+            return false;
+        }
+        bool ok = false;
+        const QString value = arguments[++i];
+        if(name == QLatin1String("--contacts")) {
+            options->source.contactCount = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--attributes")) {
+            const QStringList range = value.split(QLatin1Char('-'));
+            options->source.minimumAttributes = range.first().toInt(&ok);
+            options->source.maximumAttributes = ok ? range.last().toInt(&ok) : 0;
+        }
+        else if(name == QLatin1String("--photos")) {
+            options->source.photoPercent = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--accounts")) {
+            options->source.accountCount = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--list-latency")) {
+            options->source.listLatencyMsecs = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--details-latency")) {
+            options->source.detailsLatencyMsecs = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--seed")) {
+            options->source.seed = value.toUInt(&ok);
+        }
+        else if(name == QLatin1String("--searches")) {
+            options->searchCount = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--details")) {
+            options->detailsCount = value.toInt(&ok);
+        }
+        if(!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    qRegisterMetaType<ContactListPage>("ContactListPage");
+
+    BenchmarkOptions options;
+    if(!parseArguments(app.arguments(), &options)) {
+        fprintf(stderr, "Usage: benchmark [--contacts N] [--attributes MIN-MAX] [--photos PERCENT]\n"
+            "                 [--accounts N] [--list-latency MSECS] [--details-latency MSECS]\n"
+            "                 [--seed N] [--searches N] [--details N] [--partitioned]\n");
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    SyntheticContactSource *syntheticSource = new SyntheticContactSource(options.source);
+    ContactSourcePointer source(syntheticSource);
+    report("generate", timer.elapsed(), "ms");
+
+    // Full load, with the pages consumed on this thread
+    ContactSearchIndex index;
+    QThread loadThread;
+    ContactsLoader *loader = new ContactsLoader(source, 1);
+    loader->setPartitioned(options.partitioned);
+    PageReceiver receiver(loader, &index);
+    QEventLoop eventLoop;
+    QObject::connect(loader, SIGNAL(pageLoaded(int,ContactListPage)),
+        &receiver, SLOT(onPageLoaded(int,ContactListPage)));
+    QObject::connect(loader, SIGNAL(finished(int)), &eventLoop, SLOT(quit()));
+    QObject::connect(&loadThread, SIGNAL(started()), loader, SLOT(start()));
+    QObject::connect(&loadThread, SIGNAL(finished()), loader, SLOT(deleteLater()));
+    loader->moveToThread(&loadThread);
+
+    timer.restart();
+    loadThread.start();
+    eventLoop.exec();
+    const qint64 loadMsecs = timer.elapsed();
+    loadThread.quit();
+    loadThread.wait();
+
+    report("load.contacts", receiver.contactCount(), "contacts");
+    report("load.first_page", receiver.firstPageMsecs(), "ms");
+    report("load.total", loadMsecs, "ms");
+
+    // Searches for fragments of existing names, from one to six characters
+    QVector<qint64> searchTimes;
+    searchTimes.reserve(options.searchCount);
+    int matchCount = 0;
+    for(int i = 0; i < options.searchCount && syntheticSource->size() > 0; i++) {
+        const QString &name = syntheticSource->entry((i * 7919) % syntheticSource->size()).displayName;
+        const int length = 1 + i % 6;
+        const QString query = name.mid((i * 31) % qMax(1, name.length() - length), length);
+
+        QElapsedTimer searchTimer;
+        searchTimer.start();
+        matchCount += index.search(query).size();
+        searchTimes.append(searchTimer.nsecsElapsed());
+    }
+    reportTimes("search", searchTimes);
+    report("search.matches.mean", searchTimes.isEmpty() ? 0.0 : double(matchCount) / searchTimes.size(), "contacts");
+
+    // Detail pages, split between reading the contact and building the rows
+    QVector<qint64> fetchTimes;
+    QVector<qint64> buildTimes;
+    QList<ContactRecord> detailContacts;
+    for(int i = 0; i < options.detailsCount && syntheticSource->size() > 0; i++) {
+        const int contactId = syntheticSource->entry((i * 104729) % syntheticSource->size()).contactId;
+
+        QElapsedTimer detailsTimer;
+        detailsTimer.start();
+        const ContactRecord contact = source->contactDetails(contactId);
+        fetchTimes.append(detailsTimer.nsecsElapsed());
+
+        detailsTimer.restart();
+        const QVariantList properties = ContactDetailsLoader::contactProperties(contact);
+        const QVariantList attributes = ContactDetailsLoader::contactAttributes(contact);
+        buildTimes.append(detailsTimer.nsecsElapsed());
+        Q_UNUSED(properties);
+        Q_UNUSED(attributes);
+        detailContacts.append(contact);
+    }
+    reportTimes("details.fetch", fetchTimes);
+    reportTimes("details.build", buildTimes);
+
+    // Export size of the same contacts, as JSON Lines and as binary blocks
+    // of a scanner page each
+    if(!detailContacts.isEmpty()) {
+        QByteArray jsonData;
+        QBuffer jsonBuffer(&jsonData);
+        jsonBuffer.open(QIODevice::WriteOnly);
+        JsonWriter writer(&jsonBuffer);
+        foreach(const ContactRecord &contact, detailContacts) {
+            ContactExporter::writeContact(writer, contact);
+            writer.endLine();
+        }
+        writer.flush();
+
+        qint64 binarySize = 0;
+        for(int i = 0; i < detailContacts.size(); i += 100) {
+            binarySize += BinaryExporter::encodeBlock(detailContacts.mid(i, 100)).size();
+        }
+        report("export.json.bytes", double(jsonData.size()) / detailContacts.size(), "bytes/contact");
+        report("export.binary.bytes", double(binarySize) / detailContacts.size(), "bytes/contact");
+        report("export.binary.ratio", 100.0 * binarySize / qMax(1, jsonData.size()), "%");
+    }
+
+    report("memory.peak", peakMemoryKilobytes(), "kB");
+    return 0;
+}
+
+#include "main.moc"
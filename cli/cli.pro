@@ -0,0 +1,13 @@
+# Headless command-line inspector, for running inspections from scripts.
+# Builds with a desktop Qt 4.8:
+#   qmake cli.pro && make && ./inspector --dump contacts.jsonl stats
+
+TEMPLATE = app
+TARGET = inspector
+QT = core
+CONFIG += console warn_on release
+CONFIG -= app_bundle
+
+include(../src/portable.pri)
+
+SOURCES += main.cpp
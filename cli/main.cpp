@@ -0,0 +1,557 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QEventLoop>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QtAlgorithms>
+
+#include <stdio.h>
+
+#include "contactsloader.hpp"
+#include "contactsearchindex.hpp"
+#include "contactscanner.hpp"
+#include "contactexporter.hpp"
+#include "contactstatistics.hpp"
+#include "binaryexport.hpp"
+#include "duplicatedetector.hpp"
+#include "exportdiff.hpp"
+#include "jsonwriter.hpp"
+#include "syntheticcontactsource.hpp"
+#include "dumpcontactsource.hpp"
+
+namespace
+{
+struct InspectorOptions
+{
+    InspectorOptions() : threadCount(0), partitioned(false) { }
+    SyntheticContactOptions source;
+    QString dumpFileName;
+    int threadCount;
+    bool partitioned;
+};
+
+struct Job
+{
+    QString name;
+    QStringList arguments;
+};
+
+struct JobEntry
+{
+    const char *name;
+    int argumentCount;
+};
+
+const JobEntry jobEntries[] = {
+    { "list", 0 },
+    { "search", 1 },
+    { "dump", 1 },
+    { "export", 1 },
+    { "stats", 0 },
+    { "duplicates", 0 },
+    { "convert", 2 },
+    { "diff", 3 }
+};
+
+const int jobEntryCount = sizeof(jobEntries) / sizeof(jobEntries[0]);
+
+/**
+ * Collects the pages of a load, the way the contact list does.
+ */
+class ListReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    ListReceiver(ContactsLoader *loader) : loader_(loader) { }
+    const QList<ContactListEntry> &entries() const { return entries_; }
+public slots:
+    void onPageLoaded(int generation, const ContactListPage &page)
+    {
+        Q_UNUSED(generation);
+        foreach(const ContactListEntry &entry, *page) {
+            entries_.append(entry);
+        }
+        loader_->pageConsumed(page->size(), 0);
+    }
+private:
+    ContactsLoader *loader_;
+    QList<ContactListEntry> entries_;
+};
+
+/**
+ * Records the outcome of a scan, which runs on the calling thread.
+ */
+class ScanReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    ScanReceiver() : contactCount_(0), success_(false) { }
+    int contactCount() const { return contactCount_; }
+    bool success() const { return success_; }
+public slots:
+    void onProgress(int contactCount) { contactCount_ = contactCount; }
+    void onFinished(bool success) { success_ = success; }
+private:
+    int contactCount_;
+    bool success_;
+};
+
+/**
+ * Runs jobs against a contact source, writing their results to standard
+ * output and one line of JSON with the timing of each job to standard
+ * error.
+ */
+class Inspector
+{
+public:
+    Inspector(const InspectorOptions &options) : options_(options), listLoaded_(false), contactCount_(0)
+    {
+        output_.open(stdout, QIODevice::WriteOnly);
+        timing_.open(stderr, QIODevice::WriteOnly);
+    }
+
+    bool openSource()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        bool success = true;
+        if(options_.dumpFileName.isEmpty()) {
+            SyntheticContactSource *syntheticSource = new SyntheticContactSource(options_.source);
+            source_ = ContactSourcePointer(syntheticSource);
+            contactCount_ = syntheticSource->size();
+        }
+        else {
+            DumpContactSource *dumpSource = new DumpContactSource(options_.dumpFileName);
+            success = dumpSource->open();
+            if(!success) {
+                error_ = dumpSource->errorString();
+            }
+            source_ = ContactSourcePointer(dumpSource);
+            contactCount_ = dumpSource->size();
+        }
+        report(QLatin1String("open"), timer.elapsed(), success);
+        return success;
+    }
+
+    bool run(const Job &job)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        error_.clear();
+        contactCount_ = 0;
+
+        bool success = false;
+        if(job.name == QLatin1String("list")) {
+            success = list();
+        }
+        else if(job.name == QLatin1String("search")) {
+            success = search(job.arguments[0]);
+        }
+        else if(job.name == QLatin1String("dump")) {
+            success = dump(job.arguments[0]);
+        }
+        else if(job.name == QLatin1String("export")) {
+            success = exportAll(job.arguments[0]);
+        }
+        else if(job.name == QLatin1String("stats")) {
+            success = stats();
+        }
+        else if(job.name == QLatin1String("duplicates")) {
+            success = duplicates();
+        }
+        else if(job.name == QLatin1String("convert")) {
+            success = convert(job.arguments[0], job.arguments[1]);
+        }
+        else if(job.name == QLatin1String("diff")) {
+            success = diff(job.arguments[0], job.arguments[1], job.arguments[2]);
+        }
+        report(job.name, timer.elapsed(), success);
+        return success;
+    }
+
+private:
+    void report(const QString &job, qint64 msecs, bool success)
+    {
+        // Results are written out before the timing that covers them
+        output_.flush();
+
+        JsonWriter writer(&timing_);
+        writer.beginObject();
+        writer.writeName("contacts");
+        writer.writeNumber(contactCount_);
+        if(!error_.isEmpty()) {
+            writer.writeName("error");
+            writer.writeString(error_);
+        }
+        writer.writeName("job");
+        writer.writeString(job);
+        writer.writeName("msecs");
+        writer.writeNumber(msecs);
+        writer.writeName("success");
+        writer.writeBool(success);
+        writer.writeName("threads");
+        writer.writeNumber(options_.threadCount > 0 ? options_.threadCount : qMax(2, QThread::idealThreadCount()));
+        writer.endObject();
+        writer.endLine();
+        writer.flush();
+        timing_.flush();
+    }
+
+    /**
+     * Loads the contact list and its search index once, for the jobs
+     * that need them, reporting the load as a job of its own.
+     */
+    void loadList()
+    {
+        if(listLoaded_) { return; }
+
+        const QString error = error_;
+        const int contactCount = contactCount_;
+        QElapsedTimer timer;
+        timer.start();
+
+        QThread loadThread;
+        ContactsLoader *loader = new ContactsLoader(source_, 1);
+        loader->setPartitioned(options_.partitioned);
+        ListReceiver receiver(loader);
+        QEventLoop eventLoop;
+        QObject::connect(loader, SIGNAL(pageLoaded(int,ContactListPage)),
+            &receiver, SLOT(onPageLoaded(int,ContactListPage)));
+        QObject::connect(loader, SIGNAL(finished(int)), &eventLoop, SLOT(quit()));
+        QObject::connect(&loadThread, SIGNAL(started()), loader, SLOT(start()));
+        QObject::connect(&loadThread, SIGNAL(finished()), loader, SLOT(deleteLater()));
+        loader->moveToThread(&loadThread);
+        loadThread.start();
+        eventLoop.exec();
+        loadThread.quit();
+        loadThread.wait();
+
+        entries_ = receiver.entries();
+        foreach(const ContactListEntry &entry, entries_) {
+            index_.add(entry.contactId, entry.displayName, entry.displayCompanyName);
+        }
+        listLoaded_ = true;
+
+        error_.clear();
+        contactCount_ = entries_.size();
+        report(QLatin1String("load"), timer.elapsed(), true);
+        error_ = error;
+        contactCount_ = contactCount;
+    }
+
+    void writeEntry(JsonWriter &writer, const ContactListEntry &entry)
+    {
+        writer.beginObject();
+        writer.writeName("contactId");
+        writer.writeNumber(entry.contactId);
+        writer.writeName("displayCompanyName");
+        writer.writeString(entry.displayCompanyName);
+        writer.writeName("displayName");
+        writer.writeString(entry.displayName);
+        writer.endObject();
+        writer.endLine();
+    }
+
+    bool list()
+    {
+        loadList();
+        JsonWriter writer(&output_);
+        foreach(const ContactListEntry &entry, entries_) {
+            writeEntry(writer, entry);
+        }
+        contactCount_ = entries_.size();
+        return writer.flush();
+    }
+
+    bool search(const QString &text)
+    {
+        loadList();
+        QHash<int, int> rows;
+        for(int i = 0; i < entries_.size(); i++) {
+            rows.insert(entries_[i].contactId, i);
+        }
+
+        // Matches are listed in display order, as the application shows them
+        QList<int> matches;
+        foreach(int contactId, index_.search(text)) {
+            if(rows.contains(contactId)) {
+                matches.append(rows.value(contactId));
+            }
+        }
+        qSort(matches);
+
+        JsonWriter writer(&output_);
+        foreach(int row, matches) {
+            writeEntry(writer, entries_[row]);
+        }
+        contactCount_ = matches.size();
+        return writer.flush();
+    }
+
+    bool dump(const QString &contactId)
+    {
+        bool ok = false;
+        const int id = contactId.toInt(&ok);
+        const ContactRecord contact = ok ? source_->contactDetails(id) : ContactRecord();
+        if(!contact.isValid()) {
+            error_ = QString("No contact with ID %1").arg(contactId);
+            return false;
+        }
+        contactCount_ = 1;
+
+        JsonWriter writer(&output_, true);
+        ContactExporter::writeContact(writer, contact);
+        return writer.flush() && output_.putChar('\n');
+    }
+
+    bool scan(ContactScanner &scanner)
+    {
+        scanner.setMaxThreadCount(options_.threadCount);
+        ScanReceiver receiver;
+        QObject::connect(&scanner, SIGNAL(progress(int)), &receiver, SLOT(onProgress(int)));
+        QObject::connect(&scanner, SIGNAL(finished(bool)), &receiver, SLOT(onFinished(bool)));
+        scanner.start();
+        contactCount_ = receiver.contactCount();
+        if(!receiver.success()) {
+            error_ = QLatin1String("Scan failed");
+        }
+        return receiver.success();
+    }
+
+    bool exportAll(const QString &fileName)
+    {
+        ContactScanHandler *handler;
+        if(fileName.endsWith(QLatin1String(".cibx"), Qt::CaseInsensitive)) {
+            handler = new BinaryExportHandler(fileName);
+        }
+        else {
+            handler = new BulkExportHandler(fileName);
+        }
+        ContactScanner scanner(source_, handler);
+        return scan(scanner);
+    }
+
+    bool stats()
+    {
+        // The scanner owns the handler, so the statistics are written
+        // before it goes away
+        ContactStatisticsHandler *handler = new ContactStatisticsHandler();
+        ContactScanner scanner(source_, handler);
+        if(!scan(scanner)) { return false; }
+
+        JsonWriter writer(&output_);
+        handler->statistics().write(writer);
+        writer.endLine();
+        return writer.flush();
+    }
+
+    bool duplicates()
+    {
+        DuplicateDetector *detector = new DuplicateDetector();
+        ContactScanner scanner(source_, detector);
+        if(!scan(scanner)) { return false; }
+
+        JsonWriter writer(&output_);
+        foreach(const DuplicateGroup &group, detector->groups()) {
+            writer.beginObject();
+            writer.writeName("contactIds");
+            writer.beginArray();
+            foreach(int contactId, group.contactIds) {
+                writer.writeNumber(contactId);
+            }
+            writer.endArray();
+            writer.writeName("matchedKeys");
+            writer.beginArray();
+            if(group.matchedKeys & DuplicateDetector::NameKey) {
+                writer.writeString(QLatin1String("name"));
+            }
+            if(group.matchedKeys & DuplicateDetector::EmailKey) {
+                writer.writeString(QLatin1String("email"));
+            }
+            if(group.matchedKeys & DuplicateDetector::PhoneKey) {
+                writer.writeString(QLatin1String("phone"));
+            }
+            writer.endArray();
+            writer.endObject();
+            writer.endLine();
+        }
+        return writer.flush();
+    }
+
+    bool convert(const QString &inputFileName, const QString &outputFileName)
+    {
+        QFile input(inputFileName);
+        QFile output(outputFileName);
+        if(!input.open(QIODevice::ReadOnly)) {
+            error_ = input.errorString();
+            return false;
+        }
+        if(!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            error_ = output.errorString();
+            return false;
+        }
+        return BinaryExportReader::convertToJson(&input, &output, &error_);
+    }
+
+    bool diff(const QString &oldFileName, const QString &newFileName, const QString &outputFileName)
+    {
+        ExportDiff exportDiff(oldFileName, newFileName, outputFileName);
+        if(!exportDiff.run()) {
+            error_ = exportDiff.errorString();
+            return false;
+        }
+
+        int added = 0;
+        int removed = 0;
+        int modified = 0;
+        foreach(const ExportDiffEntry &entry, exportDiff.entries()) {
+            switch(entry.change) {
+            case ExportDiffEntry::Added:
+                added++;
+                break;
+            case ExportDiffEntry::Removed:
+                removed++;
+                break;
+            case ExportDiffEntry::Modified:
+                modified++;
+                break;
+            }
+        }
+        contactCount_ = exportDiff.entries().size() + exportDiff.unchangedCount();
+
+        JsonWriter writer(&output_);
+        writer.beginObject();
+        writer.writeName("added");
+        writer.writeNumber(added);
+        writer.writeName("malformed");
+        writer.writeNumber(exportDiff.malformedCount());
+        writer.writeName("modified");
+        writer.writeNumber(modified);
+        writer.writeName("removed");
+        writer.writeNumber(removed);
+        writer.writeName("unchanged");
+        writer.writeNumber(exportDiff.unchangedCount());
+        writer.endObject();
+        writer.endLine();
+        return writer.flush();
+    }
+
+    InspectorOptions options_;
+    ContactSourcePointer source_;
+    QFile output_;
+    QFile timing_;
+    QList<ContactListEntry> entries_;
+    ContactSearchIndex index_;
+    bool listLoaded_;
+    int contactCount_;
+    QString error_;
+};
+
+bool parseArguments(const QStringList &arguments, InspectorOptions *options, QList<Job> *jobs)
+{
+    for(int i = 1; i < arguments.size(); i++) {
+        const QString &name = arguments[i];
+        if(name == QLatin1String("--partitioned")) {
+            options->partitioned = true;
+            continue;
+        }
+
+        // Anything that is not an option starts a job
+        if(!name.startsWith(QLatin1String("--"))) {
+            int argumentCount = -1;
+            for(int j = 0; j < jobEntryCount; j++) {
+                if(name == QLatin1String(jobEntries[j].name)) {
+                    argumentCount = jobEntries[j].argumentCount;
+                }
+            }
+            if(argumentCount < 0 || i + argumentCount >= arguments.size()) {
+                return false;
+            }
+            Job job;
+            job.name = name;
+            job.arguments = arguments.mid(i + 1, argumentCount);
+            jobs->append(job);
+            i += argumentCount;
+            continue;
+        }
+
+        if(name == QLatin1String("--help") || i + 1 >= arguments.size()) {
+            return false;
+        }
+        bool ok = false;
+        const QString value = arguments[++i];
+        if(name == QLatin1String("--dump")) {
+            options->dumpFileName = value;
+            ok = !value.isEmpty();
+        }
+        else if(name == QLatin1String("--threads")) {
+            options->threadCount = value.toInt(&ok);
+            ok = ok && options->threadCount > 0;
+        }
+        else if(name == QLatin1String("--contacts")) {
+            options->source.contactCount = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--attributes")) {
+            const QStringList range = value.split(QLatin1Char('-'));
+            options->source.minimumAttributes = range.first().toInt(&ok);
+            options->source.maximumAttributes = ok ? range.last().toInt(&ok) : 0;
+        }
+        else if(name == QLatin1String("--photos")) {
+            options->source.photoPercent = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--accounts")) {
+            options->source.accountCount = value.toInt(&ok);
+        }
+        else if(name == QLatin1String("--seed")) {
+            options->source.seed = value.toUInt(&ok);
+        }
+        if(!ok) {
+            return false;
+        }
+    }
+    return !jobs->isEmpty();
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    qRegisterMetaType<ContactListPage>("ContactListPage");
+
+    InspectorOptions options;
+    QList<Job> jobs;
+    if(!parseArguments(app.arguments(), &options, &jobs)) {
+        fprintf(stderr, "Usage: inspector [--dump FILE | --contacts N [--attributes MIN-MAX] [--photos PERCENT]\n"
+            "                  [--accounts N] [--seed N]] [--threads N] [--partitioned] JOB...\n"
+            "Jobs:\n"
+            "  list                   list every contact in display order\n"
+            "  search TEXT            list the contacts matching a search\n"
+            "  dump ID                write the export data of a contact\n"
+            "  export FILE            export every contact, as binary if FILE ends in .cibx\n"
+            "  stats                  write statistics over every contact\n"
+            "  duplicates             list groups of likely duplicate contacts\n"
+            "  convert BINARY JSON    convert a binary export to JSON Lines\n"
+            "  diff OLD NEW OUTPUT    compare two JSON Lines exports\n"
+            "Results are written to standard output, and the timing of each job to\n"
+            "standard error, both as JSON Lines.\n");
+        return 1;
+    }
+    if(options.threadCount > 0) {
+        QThreadPool::globalInstance()->setMaxThreadCount(options.threadCount);
+    }
+
+    Inspector inspector(options);
+    if(!inspector.openSource()) {
+        return 2;
+    }
+
+    bool success = true;
+    foreach(const Job &job, jobs) {
+        success = inspector.run(job) && success;
+    }
+    return success ? 0 : 2;
+}
+
+#include "main.moc"
@@ -16,12 +16,63 @@ device {
                 -lbb \
                 -lbbsystem
 
-        SOURCES +=  $$quote($$BASEDIR/src/applicationui.cpp) \
+        SOURCES +=  $$quote($$BASEDIR/src/accountcache.cpp) \
+                 $$quote($$BASEDIR/src/applicationui.cpp) \
+                 $$quote($$BASEDIR/src/attributenames.cpp) \
+                 $$quote($$BASEDIR/src/binaryexport.cpp) \
+                 $$quote($$BASEDIR/src/contactchangemonitor.cpp) \
+                 $$quote($$BASEDIR/src/contactdetails.cpp) \
+                 $$quote($$BASEDIR/src/contactexporter.cpp) \
+                 $$quote($$BASEDIR/src/contactfiltermodel.cpp) \
+                 $$quote($$BASEDIR/src/contactlistmodel.cpp) \
+                 $$quote($$BASEDIR/src/contactlistsnapshot.cpp) \
                  $$quote($$BASEDIR/src/contactpage.cpp) \
-                 $$quote($$BASEDIR/src/main.cpp)
-
-        HEADERS +=  $$quote($$BASEDIR/src/applicationui.hpp) \
-                 $$quote($$BASEDIR/src/contactpage.hpp)
+                 $$quote($$BASEDIR/src/contactscanner.cpp) \
+                 $$quote($$BASEDIR/src/contactsearchindex.cpp) \
+                 $$quote($$BASEDIR/src/contactsloader.cpp) \
+                 $$quote($$BASEDIR/src/contactstatistics.cpp) \
+                 $$quote($$BASEDIR/src/detailscache.cpp) \
+                 $$quote($$BASEDIR/src/dumpcontactsource.cpp) \
+                 $$quote($$BASEDIR/src/duplicatedetector.cpp) \
+                 $$quote($$BASEDIR/src/exportdiff.cpp) \
+                 $$quote($$BASEDIR/src/jsonreader.cpp) \
+                 $$quote($$BASEDIR/src/jsonwriter.cpp) \
+                 $$quote($$BASEDIR/src/main.cpp) \
+                 $$quote($$BASEDIR/src/photocache.cpp) \
+                 $$quote($$BASEDIR/src/servicecontactsource.cpp) \
+                 $$quote($$BASEDIR/src/statisticspage.cpp) \
+                 $$quote($$BASEDIR/src/syntheticcontactsource.cpp) \
+                 $$quote($$BASEDIR/src/trace.cpp)
+
+        HEADERS +=  $$quote($$BASEDIR/src/accountcache.hpp) \
+                 $$quote($$BASEDIR/src/applicationui.hpp) \
+                 $$quote($$BASEDIR/src/attributenames.hpp) \
+                 $$quote($$BASEDIR/src/binaryexport.hpp) \
+                 $$quote($$BASEDIR/src/contactchangemonitor.hpp) \
+                 $$quote($$BASEDIR/src/contactdetails.hpp) \
+                 $$quote($$BASEDIR/src/contactexporter.hpp) \
+                 $$quote($$BASEDIR/src/contactfiltermodel.hpp) \
+                 $$quote($$BASEDIR/src/contactlistentry.hpp) \
+                 $$quote($$BASEDIR/src/contactlistmodel.hpp) \
+                 $$quote($$BASEDIR/src/contactlistsnapshot.hpp) \
+                 $$quote($$BASEDIR/src/contactpage.hpp) \
+                 $$quote($$BASEDIR/src/contactrecord.hpp) \
+                 $$quote($$BASEDIR/src/contactscanner.hpp) \
+                 $$quote($$BASEDIR/src/contactsearchindex.hpp) \
+                 $$quote($$BASEDIR/src/contactsloader.hpp) \
+                 $$quote($$BASEDIR/src/contactsource.hpp) \
+                 $$quote($$BASEDIR/src/contactstatistics.hpp) \
+                 $$quote($$BASEDIR/src/detailscache.hpp) \
+                 $$quote($$BASEDIR/src/dumpcontactsource.hpp) \
+                 $$quote($$BASEDIR/src/duplicatedetector.hpp) \
+                 $$quote($$BASEDIR/src/exportdiff.hpp) \
+                 $$quote($$BASEDIR/src/jsonreader.hpp) \
+                 $$quote($$BASEDIR/src/jsonwriter.hpp) \
+                 $$quote($$BASEDIR/src/photocache.hpp) \
+                 $$quote($$BASEDIR/src/servicecontactsource.hpp) \
+                 $$quote($$BASEDIR/src/statisticspage.hpp) \
+                 $$quote($$BASEDIR/src/syntheticcontactsource.hpp) \
+                 $$quote($$BASEDIR/src/trace.hpp)
     }
 
     CONFIG(release, debug|release) {
@@ -38,12 +89,63 @@ device {
                 -lbb \
                 -lbbsystem
 
-        SOURCES +=  $$quote($$BASEDIR/src/applicationui.cpp) \
+        SOURCES +=  $$quote($$BASEDIR/src/accountcache.cpp) \
+                 $$quote($$BASEDIR/src/applicationui.cpp) \
+                 $$quote($$BASEDIR/src/attributenames.cpp) \
+                 $$quote($$BASEDIR/src/binaryexport.cpp) \
+                 $$quote($$BASEDIR/src/contactchangemonitor.cpp) \
+                 $$quote($$BASEDIR/src/contactdetails.cpp) \
+                 $$quote($$BASEDIR/src/contactexporter.cpp) \
+                 $$quote($$BASEDIR/src/contactfiltermodel.cpp) \
+                 $$quote($$BASEDIR/src/contactlistmodel.cpp) \
+                 $$quote($$BASEDIR/src/contactlistsnapshot.cpp) \
                  $$quote($$BASEDIR/src/contactpage.cpp) \
-                 $$quote($$BASEDIR/src/main.cpp)
-
-        HEADERS +=  $$quote($$BASEDIR/src/applicationui.hpp) \
-                 $$quote($$BASEDIR/src/contactpage.hpp)
+                 $$quote($$BASEDIR/src/contactscanner.cpp) \
+                 $$quote($$BASEDIR/src/contactsearchindex.cpp) \
+                 $$quote($$BASEDIR/src/contactsloader.cpp) \
+                 $$quote($$BASEDIR/src/contactstatistics.cpp) \
+                 $$quote($$BASEDIR/src/detailscache.cpp) \
+                 $$quote($$BASEDIR/src/dumpcontactsource.cpp) \
+                 $$quote($$BASEDIR/src/duplicatedetector.cpp) \
+                 $$quote($$BASEDIR/src/exportdiff.cpp) \
+                 $$quote($$BASEDIR/src/jsonreader.cpp) \
+                 $$quote($$BASEDIR/src/jsonwriter.cpp) \
+                 $$quote($$BASEDIR/src/main.cpp) \
+                 $$quote($$BASEDIR/src/photocache.cpp) \
+                 $$quote($$BASEDIR/src/servicecontactsource.cpp) \
+                 $$quote($$BASEDIR/src/statisticspage.cpp) \
+                 $$quote($$BASEDIR/src/syntheticcontactsource.cpp) \
+                 $$quote($$BASEDIR/src/trace.cpp)
+
+        HEADERS +=  $$quote($$BASEDIR/src/accountcache.hpp) \
+                 $$quote($$BASEDIR/src/applicationui.hpp) \
+                 $$quote($$BASEDIR/src/attributenames.hpp) \
+                 $$quote($$BASEDIR/src/binaryexport.hpp) \
+                 $$quote($$BASEDIR/src/contactchangemonitor.hpp) \
+                 $$quote($$BASEDIR/src/contactdetails.hpp) \
+                 $$quote($$BASEDIR/src/contactexporter.hpp) \
+                 $$quote($$BASEDIR/src/contactfiltermodel.hpp) \
+                 $$quote($$BASEDIR/src/contactlistentry.hpp) \
+                 $$quote($$BASEDIR/src/contactlistmodel.hpp) \
+                 $$quote($$BASEDIR/src/contactlistsnapshot.hpp) \
+                 $$quote($$BASEDIR/src/contactpage.hpp) \
+                 $$quote($$BASEDIR/src/contactrecord.hpp) \
+                 $$quote($$BASEDIR/src/contactscanner.hpp) \
+                 $$quote($$BASEDIR/src/contactsearchindex.hpp) \
+                 $$quote($$BASEDIR/src/contactsloader.hpp) \
+                 $$quote($$BASEDIR/src/contactsource.hpp) \
+                 $$quote($$BASEDIR/src/contactstatistics.hpp) \
+                 $$quote($$BASEDIR/src/detailscache.hpp) \
+                 $$quote($$BASEDIR/src/dumpcontactsource.hpp) \
+                 $$quote($$BASEDIR/src/duplicatedetector.hpp) \
+                 $$quote($$BASEDIR/src/exportdiff.hpp) \
+                 $$quote($$BASEDIR/src/jsonreader.hpp) \
+                 $$quote($$BASEDIR/src/jsonwriter.hpp) \
+                 $$quote($$BASEDIR/src/photocache.hpp) \
+                 $$quote($$BASEDIR/src/servicecontactsource.hpp) \
+                 $$quote($$BASEDIR/src/statisticspage.hpp) \
+                 $$quote($$BASEDIR/src/syntheticcontactsource.hpp) \
+                 $$quote($$BASEDIR/src/trace.hpp)
     }
 }
 
@@ -62,12 +164,63 @@ simulator {
                 -lbb \
                 -lbbsystem
 
-        SOURCES +=  $$quote($$BASEDIR/src/applicationui.cpp) \
+        SOURCES +=  $$quote($$BASEDIR/src/accountcache.cpp) \
+                 $$quote($$BASEDIR/src/applicationui.cpp) \
+                 $$quote($$BASEDIR/src/attributenames.cpp) \
+                 $$quote($$BASEDIR/src/binaryexport.cpp) \
+                 $$quote($$BASEDIR/src/contactchangemonitor.cpp) \
+                 $$quote($$BASEDIR/src/contactdetails.cpp) \
+                 $$quote($$BASEDIR/src/contactexporter.cpp) \
+                 $$quote($$BASEDIR/src/contactfiltermodel.cpp) \
+                 $$quote($$BASEDIR/src/contactlistmodel.cpp) \
+                 $$quote($$BASEDIR/src/contactlistsnapshot.cpp) \
                  $$quote($$BASEDIR/src/contactpage.cpp) \
-                 $$quote($$BASEDIR/src/main.cpp)
-
-        HEADERS +=  $$quote($$BASEDIR/src/applicationui.hpp) \
-                 $$quote($$BASEDIR/src/contactpage.hpp)
+                 $$quote($$BASEDIR/src/contactscanner.cpp) \
+                 $$quote($$BASEDIR/src/contactsearchindex.cpp) \
+                 $$quote($$BASEDIR/src/contactsloader.cpp) \
+                 $$quote($$BASEDIR/src/contactstatistics.cpp) \
+                 $$quote($$BASEDIR/src/detailscache.cpp) \
+                 $$quote($$BASEDIR/src/dumpcontactsource.cpp) \
+                 $$quote($$BASEDIR/src/duplicatedetector.cpp) \
+                 $$quote($$BASEDIR/src/exportdiff.cpp) \
+                 $$quote($$BASEDIR/src/jsonreader.cpp) \
+                 $$quote($$BASEDIR/src/jsonwriter.cpp) \
+                 $$quote($$BASEDIR/src/main.cpp) \
+                 $$quote($$BASEDIR/src/photocache.cpp) \
+                 $$quote($$BASEDIR/src/servicecontactsource.cpp) \
+                 $$quote($$BASEDIR/src/statisticspage.cpp) \
+                 $$quote($$BASEDIR/src/syntheticcontactsource.cpp) \
+                 $$quote($$BASEDIR/src/trace.cpp)
+
+        HEADERS +=  $$quote($$BASEDIR/src/accountcache.hpp) \
+                 $$quote($$BASEDIR/src/applicationui.hpp) \
+                 $$quote($$BASEDIR/src/attributenames.hpp) \
+                 $$quote($$BASEDIR/src/binaryexport.hpp) \
+                 $$quote($$BASEDIR/src/contactchangemonitor.hpp) \
+                 $$quote($$BASEDIR/src/contactdetails.hpp) \
+                 $$quote($$BASEDIR/src/contactexporter.hpp) \
+                 $$quote($$BASEDIR/src/contactfiltermodel.hpp) \
+                 $$quote($$BASEDIR/src/contactlistentry.hpp) \
+                 $$quote($$BASEDIR/src/contactlistmodel.hpp) \
+                 $$quote($$BASEDIR/src/contactlistsnapshot.hpp) \
+                 $$quote($$BASEDIR/src/contactpage.hpp) \
+                 $$quote($$BASEDIR/src/contactrecord.hpp) \
+                 $$quote($$BASEDIR/src/contactscanner.hpp) \
+                 $$quote($$BASEDIR/src/contactsearchindex.hpp) \
+                 $$quote($$BASEDIR/src/contactsloader.hpp) \
+                 $$quote($$BASEDIR/src/contactsource.hpp) \
+                 $$quote($$BASEDIR/src/contactstatistics.hpp) \
+                 $$quote($$BASEDIR/src/detailscache.hpp) \
+                 $$quote($$BASEDIR/src/dumpcontactsource.hpp) \
+                 $$quote($$BASEDIR/src/duplicatedetector.hpp) \
+                 $$quote($$BASEDIR/src/exportdiff.hpp) \
+                 $$quote($$BASEDIR/src/jsonreader.hpp) \
+                 $$quote($$BASEDIR/src/jsonwriter.hpp) \
+                 $$quote($$BASEDIR/src/photocache.hpp) \
+                 $$quote($$BASEDIR/src/servicecontactsource.hpp) \
+                 $$quote($$BASEDIR/src/statisticspage.hpp) \
+                 $$quote($$BASEDIR/src/syntheticcontactsource.hpp) \
+                 $$quote($$BASEDIR/src/trace.hpp)
     }
 }
 
@@ -0,0 +1,128 @@
+#include "accountcache.hpp"
+
+#include <QtCore/QThreadStorage>
+#include <QtCore/QMutexLocker>
+
+#include <bb/pim/account/AccountService>
+#include <bb/pim/account/Account>
+#include <bb/pim/account/Provider>
+#include <bb/pim/account/Service>
+
+namespace
+{
+QThreadStorage<bb::pim::account::AccountService *> threadAccountService;
+
+bb::pim::account::AccountService *accountService()
+{
+    if(!threadAccountService.hasLocalData()) {
+        threadAccountService.setLocalData(new bb::pim::account::AccountService());
+    }
+    return threadAccountService.localData();
+}
+
+AccountInfo accountInfo(const bb::pim::account::Account &account)
+{
+    const bb::pim::account::Provider provider = account.provider();
+    AccountInfo info;
+    info.id = account.id();
+    info.displayName = account.displayName();
+    info.providerId = provider.id();
+    info.providerName = provider.name();
+    return info;
+}
+}
+
+AccountCache *AccountCache::instance_ = NULL;
+
+AccountCache::AccountCache(QObject *parent) : QObject(parent),
+    contactAccountsValid_(false), generation_(0)
+{
+    Q_ASSERT(!instance_);
+    instance_ = this;
+
+    // Only used for its change notifications, lookups go through a
+    // service instance belonging to the calling thread.
+    accountService_ = new bb::pim::account::AccountService(this);
+    connect(accountService_, SIGNAL(accountsChanged(bb::pim::account::AccountsChanged)),
+        this, SLOT(onAccountsChanged()));
+}
+
+AccountCache::~AccountCache()
+{
+    instance_ = NULL;
+}
+
+AccountCache *AccountCache::instance()
+{
+    return instance_;
+}
+
+AccountInfo AccountCache::account(bb::pim::contacts::AccountId accountId)
+{
+    int generation;
+    {
+        QMutexLocker locker(&mutex_);
+        QHash<bb::pim::contacts::AccountId, AccountInfo>::const_iterator it = accounts_.constFind(accountId);
+        if(it != accounts_.constEnd()) {
+            return it.value();
+        }
+        generation = generation_;
+    }
+
+    AccountInfo info = accountInfo(accountService()->account(accountId));
+    info.id = accountId;
+
+    // Do not cache details that were looked up before an invalidation
+    QMutexLocker locker(&mutex_);
+    if(generation == generation_) {
+        accounts_.insert(accountId, info);
+    }
+    return info;
+}
+
+QList<AccountInfo> AccountCache::contactAccounts()
+{
+    int generation;
+    {
+        QMutexLocker locker(&mutex_);
+        if(contactAccountsValid_) {
+            QList<AccountInfo> accounts;
+            foreach(bb::pim::contacts::AccountId accountId, contactAccountIds_) {
+                accounts.append(accounts_.value(accountId));
+            }
+            return accounts;
+        }
+        generation = generation_;
+    }
+
+    QList<AccountInfo> accounts;
+    foreach(const bb::pim::account::Account &account,
+        accountService()->accounts(bb::pim::account::Service::Contacts)) {
+        accounts.append(accountInfo(account));
+    }
+
+    QMutexLocker locker(&mutex_);
+    if(generation == generation_) {
+        contactAccountIds_.clear();
+        foreach(const AccountInfo &info, accounts) {
+            contactAccountIds_.append(info.id);
+            accounts_.insert(info.id, info);
+        }
+        contactAccountsValid_ = true;
+    }
+    return accounts;
+}
+
+void AccountCache::clear()
+{
+    QMutexLocker locker(&mutex_);
+    accounts_.clear();
+    contactAccountIds_.clear();
+    contactAccountsValid_ = false;
+    generation_++;
+}
+
+void AccountCache::onAccountsChanged()
+{
+    clear();
+}
@@ -0,0 +1,64 @@
+#ifndef ACCOUNTCACHE_HPP
+#define ACCOUNTCACHE_HPP
+
+#include <QtCore/QObject>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <bb/pim/contacts/Contact>
+
+namespace bb { namespace pim { namespace account {
+class AccountService;
+}}}
+
+struct AccountInfo
+{
+    AccountInfo() : id(0) { }
+    bb::pim::contacts::AccountId id;
+    QString displayName;
+    QString providerId;
+    QString providerName;
+};
+
+/**
+ * Application-wide cache of account and provider details, shared by
+ * everything that needs to describe the source accounts of a contact.
+ *
+ * Lookups may be made from any thread. The cache is emptied whenever the
+ * account service reports a change to the accounts.
+ */
+class AccountCache : public QObject
+{
+    Q_OBJECT
+public:
+    AccountCache(QObject *parent=0);
+    virtual ~AccountCache();
+
+    static AccountCache *instance();
+
+    AccountInfo account(bb::pim::contacts::AccountId accountId);
+
+    /**
+     * Returns the accounts holding contacts, including the local account
+     * of the device.
+     */
+    QList<AccountInfo> contactAccounts();
+
+    void clear();
+
+private slots:
+    void onAccountsChanged();
+
+private:
+    static AccountCache *instance_;
+    bb::pim::account::AccountService *accountService_;
+    QMutex mutex_;
+    QHash<bb::pim::contacts::AccountId, AccountInfo> accounts_;
+    QList<bb::pim::contacts::AccountId> contactAccountIds_;
+    bool contactAccountsValid_;
+    int generation_;
+};
+
+#endif // ACCOUNTCACHE_HPP
@@ -1,6 +1,15 @@
 #include "applicationui.hpp"
 
 #include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTimer>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QThreadPool>
+#include <QtCore/QDebug>
+#include <QtDeclarative/qdeclarative.h>
 
 #include <bb/cascades/Application>
 #include <bb/cascades/QmlDocument>
@@ -12,21 +21,84 @@
 #include <bb/cascades/Sheet>
 #include <bb/cascades/ListView>
 #include <bb/cascades/GroupDataModel>
-#include <bb/pim/contacts/ContactService>
+#include <bb/cascades/pickers/FilePicker>
 #include <bb/pim/contacts/Contact>
-#include <bb/pim/contacts/ContactListFilters>
 #include <bb/system/InvokeManager>
 #include <bb/system/InvokeRequest>
 #include <bb/system/SystemPrompt>
+#include <bb/system/SystemUiInputField>
+#include <bb/system/SystemToast>
 #include <bb/ApplicationInfo>
 
 #include "contactpage.hpp"
+#include "contactsloader.hpp"
+#include "contactfiltermodel.hpp"
+#include "accountcache.hpp"
+#include "attributenames.hpp"
+#include "photocache.hpp"
+#include "detailscache.hpp"
+#include "servicecontactsource.hpp"
+#include "dumpcontactsource.hpp"
+#include "trace.hpp"
+#include "contactscanner.hpp"
+#include "contactexporter.hpp"
+#include "binaryexport.hpp"
+#include "duplicatedetector.hpp"
+#include "contactstatistics.hpp"
+#include "statisticspage.hpp"
+#include "exportdiff.hpp"
 
 using namespace bb::cascades;
 
-ApplicationUI::ApplicationUI(bb::cascades::Application *app) : QObject(app), loadThread_(NULL)
+namespace
 {
-    qRegisterMetaType<QList<bb::pim::contacts::Contact> >("QList<bb::pim::contacts::Contact>");
+// Contacts on either side of a touched contact whose details are prefetched
+const int PrefetchDistance = 2;
+
+// Changes made to contacts are saved to the snapshot at most this often
+const int SnapshotDelayMsecs = 10000;
+
+QString snapshotFileName()
+{
+    return QDir::homePath() + QLatin1String("/contactlist.snapshot");
+}
+
+bool sameEntry(const ContactListEntry &entry1, const ContactListEntry &entry2)
+{
+    return entry1.contactId == entry2.contactId
+        && entry1.displayName == entry2.displayName
+        && entry1.displayCompanyName == entry2.displayCompanyName
+        && entry1.photoFilepath == entry2.photoFilepath;
+}
+
+// Attribute kinds read from dumps are given the values the service uses
+int attributeKindValue(const QString &name, bool *ok)
+{
+    return AttributeNames::kind(name, ok);
+}
+
+int attributeSubKindValue(const QString &name, bool *ok)
+{
+    return AttributeNames::subKind(name, ok);
+}
+}
+
+ApplicationUI::ApplicationUI(bb::cascades::Application *app) : QObject(app),
+    offline_(false), loadThread_(NULL), loader_(NULL), pendingMsecs_(0), loadGeneration_(0),
+    reconciling_(false), searchPosition_(-1), exportScanner_(NULL),
+    duplicateScanner_(NULL), duplicateDetector_(NULL),
+    statisticsScanner_(NULL), statisticsHandler_(NULL), exportDiff_(NULL),
+    dumpOpener_(NULL)
+{
+    qRegisterMetaType<ContactListPage>("ContactListPage");
+    qRegisterMetaType<ContactDetails>("ContactDetails");
+    qmlRegisterType<ContactListModel>("org.logicprobe.ContactsInspector", 1, 0, "ContactListModel");
+
+    new AccountCache(this);
+    new PhotoCache(this);
+    serviceSource_ = ContactSourcePointer(new ServiceContactSource());
+    contactSource_ = serviceSource_;
+    new DetailsCache(contactSource_, this);
 
     translator_ = new QTranslator(this);
     localeHandler_ = new LocaleHandler(this);
@@ -45,8 +117,30 @@ ApplicationUI::ApplicationUI(bb::cascades::Application *app) : QObject(app), loa
     connect(page_, SIGNAL(refreshList()), this, SLOT(onRefreshContactsList()));
     connect(page_, SIGNAL(search()), this, SLOT(onSearch()));
     connect(page_, SIGNAL(openContact(int)), this, SLOT(onOpenContact(int)));
+    connect(page_, SIGNAL(contactActivated(int)), this, SLOT(onContactActivated(int)));
+    connect(page_, SIGNAL(filterChanged(QString)), this, SLOT(onFilterChanged(QString)));
+    connect(page_, SIGNAL(exportAll()), this, SLOT(onExportAll()));
+    connect(page_, SIGNAL(exportBinary()), this, SLOT(onExportBinary()));
+    connect(page_, SIGNAL(findDuplicates()), this, SLOT(onFindDuplicates()));
+    connect(page_, SIGNAL(showStatistics()), this, SLOT(onShowStatistics()));
+    connect(page_, SIGNAL(compareExports()), this, SLOT(onCompareExports()));
+    connect(page_, SIGNAL(openDump()), this, SLOT(onOpenDump()));
+    connect(page_, SIGNAL(closeDump()), this, SLOT(onCloseDump()));
 
-    dataModel_ = page_->findChild<GroupDataModel*>("dataModel");
+    dataModel_ = page_->findChild<ContactListModel*>("dataModel");
+    connect(dataModel_, SIGNAL(contentsChanged()), this, SLOT(onContactListChanged()));
+
+    snapshotTimer_ = new QTimer(this);
+    snapshotTimer_->setSingleShot(true);
+    snapshotTimer_->setInterval(SnapshotDelayMsecs);
+    connect(snapshotTimer_, SIGNAL(timeout()), this, SLOT(onSaveSnapshot()));
+    connect(app, SIGNAL(aboutToQuit()), this, SLOT(onAboutToQuit()));
+
+    filterModel_ = new ContactFilterModel(dataModel_, this);
+
+    changeMonitor_ = new ContactChangeMonitor(contactSource_, this);
+    connect(changeMonitor_, SIGNAL(contactsUpdated(ContactListUpdate)), this, SLOT(onContactsUpdated(ContactListUpdate)));
+    connect(changeMonitor_, SIGNAL(reloadRequired()), this, SLOT(onReloadRequired()));
 
     ActionItem *aboutItem = ActionItem::create()
         .title(tr("About"))
@@ -55,13 +149,30 @@ ApplicationUI::ApplicationUI(bb::cascades::Application *app) : QObject(app), loa
 
     app->setScene(navPane_);
 
-    app->setMenu(Menu::create().addAction(aboutItem));
+    traceItem_ = ActionItem::create()
+        .title(tr("Start Tracing"))
+        .onTriggered(this, SLOT(onTraceActionTriggered()));
+
+    app->setMenu(Menu::create().addAction(aboutItem).addAction(traceItem_));
     app->setMenuEnabled(true);
 
     bb::ApplicationInfo appInfo;
     page_->setProperty("appName", appInfo.title());
-    page_->setProperty("activityRunning", true);
-    QMetaObject::invokeMethod(this, "onRefreshContactsList", Qt::QueuedConnection);
+
+    // Show the list from the previous run right away, and bring it up to
+    // date in the background
+    if(snapshot_.open(snapshotFileName())) {
+        const QList<ContactListEntry> entries = snapshot_.entries();
+        dataModel_->insertList(entries);
+        foreach(const ContactListEntry &entry, entries) {
+            searchIndex_.add(entry.contactId, entry.displayName, entry.displayCompanyName);
+        }
+        startLoad(true);
+    }
+    else {
+        page_->setProperty("activityRunning", true);
+        QMetaObject::invokeMethod(this, "onRefreshContactsList", Qt::QueuedConnection);
+    }
 }
 
 void ApplicationUI::onSystemLanguageChanged()
@@ -121,41 +232,240 @@ void ApplicationUI::onOpenUrlInBrowser(const QString &url) {
 
 void ApplicationUI::onRefreshContactsList()
 {
-    if(loadThread_) { return; }
-
+    page_->setProperty("activityRunning", true);
     dataModel_->clear();
+    searchIndex_.clear();
+    searchText_.clear();
+    searchMatches_.clear();
+    DetailsCache::instance()->clear();
+    startLoad(false);
+}
+
+void ApplicationUI::startLoad(bool reconcile)
+{
+    // A load already in progress is superseded by the new one
+    if(loader_) {
+        loader_->cancel();
+        loadThread_ = NULL;
+        loader_ = NULL;
+    }
+    loadGeneration_++;
+    pendingEntries_.clear();
+    pendingPageSizes_.clear();
+    pendingMsecs_ = 0;
+
+    reconciling_ = reconcile;
+    reconcileEntries_.clear();
+
+    // The load picks up any changes made while it runs, and the monitor
+    // catches up with whatever it missed once the load is complete.
+    changeMonitor_->setPaused(true);
 
     loadThread_ = new QThread(this);
-    ContactsLoader *loader = new ContactsLoader();
-    connect(loader, SIGNAL(pageLoaded(QList<bb::pim::contacts::Contact>)),
-        this, SLOT(onContactsPageLoaded(QList<bb::pim::contacts::Contact>)));
-    connect(loader, SIGNAL(finished()), this, SLOT(onContactsLoadFinished()));
-    connect(loadThread_, SIGNAL(started()), loader, SLOT(start()));
+    loader_ = new ContactsLoader(contactSource_, loadGeneration_);
+    loader_->setPartitioned(true);
+    connect(loader_, SIGNAL(pageLoaded(int,ContactListPage)),
+        this, SLOT(onContactsPageLoaded(int,ContactListPage)));
+    connect(loader_, SIGNAL(finished(int)), this, SLOT(onContactsLoadFinished(int)));
+    connect(loader_, SIGNAL(finished(int)), loadThread_, SLOT(quit()));
+    connect(loadThread_, SIGNAL(started()), loader_, SLOT(start()));
+    connect(loadThread_, SIGNAL(finished()), loader_, SLOT(deleteLater()));
     connect(loadThread_, SIGNAL(finished()), loadThread_, SLOT(deleteLater()));
-    loader->moveToThread(loadThread_);
+    loader_->moveToThread(loadThread_);
     loadThread_->start();
 }
 
-void ApplicationUI::onContactsPageLoaded(const QList<bb::pim::contacts::Contact> &contactsPage)
+void ApplicationUI::onContactsPageLoaded(int generation, const ContactListPage &page)
 {
-    foreach(const bb::pim::contacts::Contact &contact, contactsPage) {
-        if(!contact.isValid()) { continue; }
-        QVariantMap map;
-        map["displayName"] = contact.displayName();
-        map["displayCompanyName"] = contact.displayCompanyName();
-        map["contactId"] = contact.id();
-        if(!contact.smallPhotoFilepath().isEmpty()) {
-            map["photo"] = QLatin1String("file://") + contact.smallPhotoFilepath();
+    // Pages still queued from a superseded load are dropped
+    if(generation != loadGeneration_) { return; }
+    TRACE_SCOPE("ui", "pageLoaded");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // While reconciling, the snapshot stays on screen until the load finishes
+    if(reconciling_) {
+        foreach(const ContactListEntry &entry, *page) {
+            reconcileEntries_.append(entry);
+        }
+        loader_->pageConsumed(page->size(), timer.elapsed());
+        return;
+    }
+
+    foreach(const ContactListEntry &entry, *page) {
+        pendingEntries_.append(entry);
+        searchIndex_.add(entry.contactId, entry.displayName, entry.displayCompanyName);
+    }
+
+    // Pages that arrive together are merged into the model in one batch
+    if(pendingPageSizes_.isEmpty()) {
+        QTimer::singleShot(0, this, SLOT(onFlushPendingContacts()));
+    }
+    pendingPageSizes_.append(page->size());
+    pendingMsecs_ += timer.elapsed();
+}
+
+void ApplicationUI::onFlushPendingContacts()
+{
+    TRACE_SCOPE("ui", "insertList");
+    if(pendingPageSizes_.isEmpty()) { return; }
+
+    QElapsedTimer timer;
+    timer.start();
+    dataModel_->insertList(pendingEntries_);
+    pendingMsecs_ += timer.elapsed();
+
+    if(loader_) {
+        int totalSize = 0;
+        foreach(int pageSize, pendingPageSizes_) {
+            totalSize += pageSize;
+        }
+        foreach(int pageSize, pendingPageSizes_) {
+            loader_->pageConsumed(pageSize, (totalSize > 0) ? (pendingMsecs_ * pageSize / totalSize) : 0);
         }
-        dataModel_->insert(map);
     }
+
+    pendingEntries_.clear();
+    pendingPageSizes_.clear();
+    pendingMsecs_ = 0;
 }
 
-void ApplicationUI::onContactsLoadFinished()
+void ApplicationUI::onContactsLoadFinished(int generation)
 {
+    if(generation != loadGeneration_) { return; }
+
+    onFlushPendingContacts();
+    if(reconciling_) {
+        reconcileContacts();
+    }
     page_->setProperty("activityRunning", false);
-    loadThread_->quit();
     loadThread_ = NULL;
+    loader_ = NULL;
+
+    // A dump is neither saved as the snapshot of the device's contacts,
+    // nor kept up to date with changes made to them
+    if(!offline_) {
+        saveSnapshot();
+        changeMonitor_->setPaused(false);
+    }
+}
+
+void ApplicationUI::onContactsUpdated(const ContactListUpdate &update)
+{
+    TRACE_SCOPE("ui", "applyUpdate");
+    dataModel_->updateList(update.entries, update.removedContactIds);
+
+    QList<int> contactIds = update.removedContactIds;
+    foreach(const ContactListEntry &entry, update.entries) {
+        contactIds.append(entry.contactId);
+    }
+    DetailsCache::instance()->invalidate(contactIds);
+
+    foreach(int contactId, update.removedContactIds) {
+        searchIndex_.remove(contactId);
+    }
+    foreach(const ContactListEntry &entry, update.entries) {
+        searchIndex_.add(entry.contactId, entry.displayName, entry.displayCompanyName);
+    }
+    searchText_.clear();
+    searchMatches_.clear();
+
+    // Bursts of changes during a sync are saved together
+    if(!snapshotTimer_->isActive()) {
+        snapshotTimer_->start();
+    }
+}
+
+void ApplicationUI::onSaveSnapshot()
+{
+    if(offline_) { return; }
+    saveSnapshot();
+}
+
+void ApplicationUI::onAboutToQuit()
+{
+    savePendingSnapshot();
+}
+
+void ApplicationUI::onReloadRequired()
+{
+    // Reloaded in the background, keeping the current list on screen,
+    // and restarting any load already in progress.
+    DetailsCache::instance()->clear();
+    startLoad(true);
+}
+
+void ApplicationUI::reconcileContacts()
+{
+    TRACE_SCOPE("ui", "reconcile");
+    reconciling_ = false;
+    const QList<ContactListEntry> entries = reconcileEntries_;
+    reconcileEntries_.clear();
+
+    // Only the rows that differ from the snapshot are patched, so that
+    // the list keeps its scroll position and the search its place
+    QList<ContactListEntry> changedEntries;
+    QSet<int> contactIds;
+    foreach(const ContactListEntry &entry, entries) {
+        contactIds.insert(entry.contactId);
+        const int row = dataModel_->rowForContact(entry.contactId);
+        if(row < 0 || !sameEntry(dataModel_->entry(row), entry)) {
+            changedEntries.append(entry);
+        }
+    }
+    QList<int> removedContactIds;
+    for(int row = 0; row < dataModel_->size(); row++) {
+        if(!contactIds.contains(dataModel_->contactId(row))) {
+            removedContactIds.append(dataModel_->contactId(row));
+        }
+    }
+    if(changedEntries.isEmpty() && removedContactIds.isEmpty()) { return; }
+
+    dataModel_->updateList(changedEntries, removedContactIds);
+    foreach(int contactId, removedContactIds) {
+        searchIndex_.remove(contactId);
+        const int match = searchMatches_.indexOf(contactId);
+        if(match >= 0) {
+            searchMatches_.removeAt(match);
+            if(match <= searchPosition_) {
+                searchPosition_--;
+            }
+        }
+    }
+    foreach(const ContactListEntry &entry, changedEntries) {
+        searchIndex_.add(entry.contactId, entry.displayName, entry.displayCompanyName);
+    }
+}
+
+void ApplicationUI::saveSnapshot()
+{
+    snapshotTimer_->stop();
+    QList<ContactListEntry> entries;
+    entries.reserve(dataModel_->size());
+    for(int row = 0; row < dataModel_->size(); row++) {
+        entries.append(dataModel_->entry(row));
+    }
+    QThreadPool::globalInstance()->start(new ContactListSnapshotWriter(snapshotFileName(), entries));
+}
+
+void ApplicationUI::savePendingSnapshot()
+{
+    if(snapshotTimer_->isActive()) {
+        snapshotTimer_->stop();
+        onSaveSnapshot();
+    }
+}
+
+void ApplicationUI::setContactSource(const ContactSourcePointer &source, bool offline)
+{
+    // Changes still waiting to be saved belong to the previous list
+    savePendingSnapshot();
+    offline_ = offline;
+    contactSource_ = source;
+    DetailsCache::instance()->setSource(source);
+    page_->setProperty("offline", offline);
+    onRefreshContactsList();
 }
 
 void ApplicationUI::onSearch()
@@ -164,62 +474,612 @@ void ApplicationUI::onSearch()
     connect(prompt, SIGNAL(finished(bb::system::SystemUiResult::Type)),
         this, SLOT(onSearchPromptFinished(bb::system::SystemUiResult::Type)));
     prompt->setTitle(tr("Search"));
+    prompt->inputField()->setDefaultText(searchText_);
     prompt->show();
 }
 
 void ApplicationUI::onSearchPromptFinished(bb::system::SystemUiResult::Type result)
 {
+    TRACE_SCOPE("ui", "search");
     bb::system::SystemPrompt *prompt = qobject_cast<bb::system::SystemPrompt *>(sender());
     prompt->deleteLater();
-    if(result == bb::system::SystemUiResult::ConfirmButtonSelection) {
-        QVariantList indexPath;
-        const QString text = prompt->inputFieldTextEntry().trimmed();
-        if(!text.isEmpty()) {
-            foreach(const QVariantMap& map, dataModel_->toListOfMaps()) {
-                if(map["displayName"].toString().contains(text, Qt::CaseInsensitive)
-                    || map["displayCompanyName"].toString().contains(text, Qt::CaseInsensitive)
-                    || map["contactId"].toString() == text) {
-                    indexPath = dataModel_->findExact(map);
-                    break;
-                }
+    if(result != bb::system::SystemUiResult::ConfirmButtonSelection) { return; }
+
+    // Repeating the previous search steps through its matches
+    const QString text = prompt->inputFieldTextEntry().trimmed();
+    if(text != searchText_) {
+        searchText_ = text;
+        searchPosition_ = -1;
+
+        QList<int> rows;
+        foreach(int contactId, searchIndex_.search(text)) {
+            const int row = dataModel_->rowForContact(contactId);
+            if(row >= 0) {
+                rows.append(row);
+            }
+        }
+        qSort(rows);
+
+        searchMatches_.clear();
+        foreach(int row, rows) {
+            searchMatches_.append(dataModel_->contactId(row));
+        }
+    }
+
+    if(searchMatches_.isEmpty()) { return; }
+    searchPosition_ = (searchPosition_ + 1) % searchMatches_.size();
+
+    const int row = dataModel_->rowForContact(searchMatches_[searchPosition_]);
+    if(row >= 0) {
+        listView_->scrollToItem(dataModel_->indexPath(row));
+    }
+
+    if(searchMatches_.size() > 1) {
+        bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+        connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+        toast->setBody(tr("Match %1 of %2").arg(searchPosition_ + 1).arg(searchMatches_.size()));
+        toast->show();
+    }
+}
+
+void ApplicationUI::onFilterChanged(const QString &text)
+{
+    TRACE_SCOPE("ui", "filter");
+    const QString trimmed = text.trimmed();
+    if(trimmed.isEmpty()) {
+        filterText_.clear();
+        listView_->setDataModel(dataModel_);
+        return;
+    }
+
+    QVector<int> rows;
+    const QString query = ContactSearchIndex::normalize(trimmed);
+    if(!filterText_.isEmpty() && query.startsWith(ContactSearchIndex::normalize(filterText_))) {
+        // A longer query can only narrow down the previous result
+        foreach(int row, filterModel_->sourceRows()) {
+            if(searchIndex_.contains(dataModel_->contactId(row), query)) {
+                rows.append(row);
             }
         }
 
-        if(!indexPath.isEmpty()) {
-            listView_->scrollToItem(indexPath);
+        // Exact ID matches do not depend on the previous result
+        bool isNumber = false;
+        const int contactId = trimmed.toInt(&isNumber);
+        const int row = isNumber ? dataModel_->rowForContact(contactId) : -1;
+        if(row >= 0) {
+            QVector<int>::iterator it = qLowerBound(rows.begin(), rows.end(), row);
+            if(it == rows.end() || *it != row) {
+                rows.insert(it, row);
+            }
+        }
+    }
+    else {
+        foreach(int contactId, searchIndex_.search(trimmed)) {
+            const int row = dataModel_->rowForContact(contactId);
+            if(row >= 0) {
+                rows.append(row);
+            }
         }
+        qSort(rows);
+    }
+
+    filterText_ = trimmed;
+    filterModel_->setSourceRows(rows);
+    if(listView_->dataModel() != filterModel_) {
+        listView_->setDataModel(filterModel_);
+    }
+}
+
+void ApplicationUI::onContactListChanged()
+{
+    // Source rows have moved, so the filter has to start over
+    if(!filterText_.isEmpty()) {
+        const QString text = filterText_;
+        filterText_.clear();
+        onFilterChanged(text);
     }
 }
 
 void ApplicationUI::onOpenContact(int contactId)
 {
     ContactPage *contactPage = new ContactPage(contactId, this);
+    const int row = dataModel_->rowForContact(contactId);
+    if(row >= 0) {
+        contactPage->setHeader(dataModel_->entry(row));
+    }
     contactPage->push(navPane_);
 }
 
-ContactsLoader::ContactsLoader(QObject *parent) : QObject(parent)
+void ApplicationUI::onContactActivated(int contactId)
+{
+    // The contact being touched is likely to be opened next, with its
+    // neighbors close behind when flipping back and forth
+    const int row = dataModel_->rowForContact(contactId);
+    if(row < 0) { return; }
+
+    QVector<int> rows;
+    int index = row;
+    if(!filterText_.isEmpty()) {
+        rows = filterModel_->sourceRows();
+        QVector<int>::const_iterator it = qBinaryFind(rows.constBegin(), rows.constEnd(), row);
+        if(it == rows.constEnd()) { return; }
+        index = it - rows.constBegin();
+    }
+    const int count = rows.isEmpty() ? dataModel_->size() : rows.size();
+
+    QList<int> contactIds;
+    contactIds.append(contactId);
+    for(int distance = 1; distance <= PrefetchDistance; distance++) {
+        if(index + distance < count) {
+            const int nextRow = rows.isEmpty() ? index + distance : rows[index + distance];
+            contactIds.append(dataModel_->contactId(nextRow));
+        }
+        if(index - distance >= 0) {
+            const int previousRow = rows.isEmpty() ? index - distance : rows[index - distance];
+            contactIds.append(dataModel_->contactId(previousRow));
+        }
+    }
+    DetailsCache::instance()->prefetch(contactIds);
+}
+
+void ApplicationUI::onExportAll()
 {
+    if(exportScanner_) { return; }
+
+    pickers::FilePicker* filePicker = new pickers::FilePicker(this);
+    filePicker->setType(pickers::FileType::Other);
+    filePicker->setMode(pickers::FilePickerMode::Saver);
+    filePicker->setDefaultSaveFileNames(QStringList() << QLatin1String("contacts.jsonl"));
+    connect(filePicker, SIGNAL(fileSelected(QStringList)), this, SLOT(onExportFileSelected(QStringList)), Qt::QueuedConnection);
+    connect(filePicker, SIGNAL(canceled()), this, SLOT(onExportPickerCanceled()));
+    filePicker->open();
 }
 
-void ContactsLoader::start()
+void ApplicationUI::onExportBinary()
 {
-    bb::pim::contacts::ContactService contactService;
+    if(exportScanner_) { return; }
 
-    const int maxLimit = 200;
-    bb::pim::contacts::ContactListFilters options;
-    options.setLimit(maxLimit);
-    options.setSortBy(bb::pim::contacts::SortColumn::FirstName, bb::pim::contacts::SortOrder::Ascending);
+    pickers::FilePicker* filePicker = new pickers::FilePicker(this);
+    filePicker->setType(pickers::FileType::Other);
+    filePicker->setMode(pickers::FilePickerMode::Saver);
+    filePicker->setDefaultSaveFileNames(QStringList() << QLatin1String("contacts.cibx"));
+    connect(filePicker, SIGNAL(fileSelected(QStringList)), this, SLOT(onExportFileSelected(QStringList)), Qt::QueuedConnection);
+    connect(filePicker, SIGNAL(canceled()), this, SLOT(onExportPickerCanceled()));
+    filePicker->open();
+}
+
+void ApplicationUI::onExportFileSelected(const QStringList &selectedFiles)
+{
+    pickers::FilePicker *picker = qobject_cast<pickers::FilePicker*>(sender());
+    picker->deleteLater();
+    if(exportScanner_ || selectedFiles.length() < 1 || selectedFiles[0].isEmpty()) { return; }
 
-    do {
-        QList<bb::pim::contacts::Contact> contactsPage = contactService.contacts(options);
-        emit pageLoaded(contactsPage);
-        if (contactsPage.size() == maxLimit) {
-            options.setAnchorId(contactsPage[maxLimit - 1].id());
+    page_->setProperty("activityText", tr("Exporting contacts"));
+    page_->setProperty("activityRunning", true);
+
+    // The format follows the extension, whichever action the file was picked from
+    ContactScanHandler *handler;
+    if(selectedFiles[0].endsWith(QLatin1String(".cibx"), Qt::CaseInsensitive)) {
+        handler = new BinaryExportHandler(selectedFiles[0]);
+    }
+    else {
+        handler = new BulkExportHandler(selectedFiles[0]);
+    }
+
+    QThread *thread = new QThread(this);
+    exportScanner_ = new ContactScanner(contactSource_, handler);
+    connect(exportScanner_, SIGNAL(progress(int)), this, SLOT(onExportProgress(int)));
+    connect(exportScanner_, SIGNAL(finished(bool)), this, SLOT(onExportFinished(bool)));
+    connect(exportScanner_, SIGNAL(finished(bool)), thread, SLOT(quit()));
+    connect(thread, SIGNAL(started()), exportScanner_, SLOT(start()));
+    connect(thread, SIGNAL(finished()), exportScanner_, SLOT(deleteLater()));
+    connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+    exportScanner_->moveToThread(thread);
+    thread->start();
+}
+
+void ApplicationUI::onExportPickerCanceled()
+{
+    pickers::FilePicker *picker = qobject_cast<pickers::FilePicker*>(sender());
+    picker->deleteLater();
+}
+
+void ApplicationUI::onExportProgress(int contactCount)
+{
+    page_->setProperty("activityText", tr("Exported %1 contacts").arg(contactCount));
+}
+
+void ApplicationUI::onExportFinished(bool success)
+{
+    exportScanner_ = NULL;
+    page_->setProperty("activityRunning", false);
+    page_->setProperty("activityText", QString());
+
+    bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+    connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+    toast->setBody(success ? tr("Contacts exported to file") : tr("Unable to export contacts"));
+    toast->show();
+}
+
+void ApplicationUI::onFindDuplicates()
+{
+    if(duplicateScanner_) { return; }
+
+    page_->setProperty("activityText", tr("Finding duplicates"));
+    page_->setProperty("activityRunning", true);
+
+    // The detector belongs to the scanner, and is only read here once the
+    // scan has finished and before the scanner is deleted.
+    QThread *thread = new QThread(this);
+    duplicateDetector_ = new DuplicateDetector();
+    duplicateScanner_ = new ContactScanner(contactSource_, duplicateDetector_);
+    connect(duplicateScanner_, SIGNAL(progress(int)), this, SLOT(onScanProgress(int)));
+    connect(duplicateScanner_, SIGNAL(finished(bool)), this, SLOT(onDuplicatesFinished(bool)));
+    connect(duplicateScanner_, SIGNAL(finished(bool)), thread, SLOT(quit()));
+    connect(thread, SIGNAL(started()), duplicateScanner_, SLOT(start()));
+    connect(thread, SIGNAL(finished()), duplicateScanner_, SLOT(deleteLater()));
+    connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+    duplicateScanner_->moveToThread(thread);
+    thread->start();
+}
+
+void ApplicationUI::onDuplicatesFinished(bool success)
+{
+    const QList<DuplicateGroup> groups = duplicateDetector_->groups();
+    duplicateScanner_ = NULL;
+    duplicateDetector_ = NULL;
+    page_->setProperty("activityRunning", false);
+    page_->setProperty("activityText", QString());
+
+    if(!success) {
+        bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+        connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+        toast->setBody(tr("Unable to scan contacts"));
+        toast->show();
+        return;
+    }
+
+    QmlDocument *qml = QmlDocument::create("asset:///ReportPage.qml").parent(this);
+    if(qml->hasErrors()) { return; }
+
+    Page *duplicatesPage = qml->createRootObject<Page>();
+    qml->setParent(duplicatesPage);
+    duplicatesPage->setProperty("reportTitle", tr("Duplicates"));
+    connect(duplicatesPage, SIGNAL(openContact(int)), this, SLOT(onOpenContact(int)));
+
+    // Each group is headed by the name of its first contact, along with
+    // what its contacts have in common. Groups are ranked largest first,
+    // which also keeps groups with the same title apart.
+    QVariantList items;
+    QVariantMap groupTitles;
+    int contactCount = 0;
+    for(int rank = 0; rank < groups.size(); rank++) {
+        const DuplicateGroup &group = groups[rank];
+        QStringList keys;
+        if(group.matchedKeys & DuplicateDetector::NameKey) {
+            keys.append(tr("name"));
+        }
+        if(group.matchedKeys & DuplicateDetector::EmailKey) {
+            keys.append(tr("email"));
         }
-        else {
+        if(group.matchedKeys & DuplicateDetector::PhoneKey) {
+            keys.append(tr("phone"));
+        }
+
+        QString groupTitle;
+        foreach(int contactId, group.contactIds) {
+            const int row = dataModel_->rowForContact(contactId);
+            const ContactListEntry entry = row >= 0 ? dataModel_->entry(row) : ContactListEntry();
+            if(groupTitle.isEmpty()) {
+                const QString name = entry.displayName.isEmpty() ? tr("ID: %1").arg(contactId) : entry.displayName;
+                groupTitle = tr("%1 (%2)").arg(name).arg(keys.join(", "));
+            }
+
+            QVariantMap map;
+            map["rank"] = rank;
+            map["title"] = entry.displayName;
+            map["description"] = entry.displayCompanyName;
+            map["status"] = contactId;
+            map["contactId"] = contactId;
+            items.append(map);
+        }
+        groupTitles[QString::number(rank)] = groupTitle;
+        contactCount += group.contactIds.size();
+    }
+
+    GroupDataModel *duplicatesModel = new GroupDataModel(QStringList() << "rank" << "title", duplicatesPage);
+    duplicatesModel->setGrouping(ItemGrouping::ByFullValue);
+    duplicatesModel->insertList(items);
+    duplicatesPage->setProperty("groupTitles", groupTitles);
+    duplicatesPage->findChild<ListView *>("listView")->setDataModel(duplicatesModel);
+    duplicatesPage->setProperty("summary",
+        tr("%1 contacts in %2 groups of likely duplicates").arg(contactCount).arg(groups.size()));
+    navPane_->push(duplicatesPage);
+}
+
+void ApplicationUI::onShowStatistics()
+{
+    if(statisticsScanner_) { return; }
+
+    page_->setProperty("activityText", tr("Collecting statistics"));
+    page_->setProperty("activityRunning", true);
+
+    QThread *thread = new QThread(this);
+    statisticsHandler_ = new ContactStatisticsHandler();
+    statisticsScanner_ = new ContactScanner(contactSource_, statisticsHandler_);
+    connect(statisticsScanner_, SIGNAL(progress(int)), this, SLOT(onScanProgress(int)));
+    connect(statisticsScanner_, SIGNAL(finished(bool)), this, SLOT(onStatisticsFinished(bool)));
+    connect(statisticsScanner_, SIGNAL(finished(bool)), thread, SLOT(quit()));
+    connect(thread, SIGNAL(started()), statisticsScanner_, SLOT(start()));
+    connect(thread, SIGNAL(finished()), statisticsScanner_, SLOT(deleteLater()));
+    connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+    statisticsScanner_->moveToThread(thread);
+    thread->start();
+}
+
+void ApplicationUI::onStatisticsFinished(bool success)
+{
+    const ContactStatistics statistics = statisticsHandler_->statistics();
+    statisticsScanner_ = NULL;
+    statisticsHandler_ = NULL;
+    page_->setProperty("activityRunning", false);
+    page_->setProperty("activityText", QString());
+
+    if(!success) {
+        bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+        connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+        toast->setBody(tr("Unable to scan contacts"));
+        toast->show();
+        return;
+    }
+
+    StatisticsPage *statisticsPage = new StatisticsPage(statistics, this);
+    connect(statisticsPage, SIGNAL(openContact(int)), this, SLOT(onOpenContact(int)));
+    statisticsPage->push(navPane_);
+}
+
+void ApplicationUI::onScanProgress(int contactCount)
+{
+    page_->setProperty("activityText", tr("Scanned %1 contacts").arg(contactCount));
+}
+
+void ApplicationUI::onCompareExports()
+{
+    if(exportDiff_) { return; }
+
+    // The first export chosen is the one changes are relative to
+    pickers::FilePicker* filePicker = new pickers::FilePicker(this);
+    filePicker->setType(pickers::FileType::Other);
+    filePicker->setMode(pickers::FilePickerMode::Picker);
+    filePicker->setTitle(tr("Select Old Export"));
+    connect(filePicker, SIGNAL(fileSelected(QStringList)), this, SLOT(onCompareOldFileSelected(QStringList)), Qt::QueuedConnection);
+    connect(filePicker, SIGNAL(canceled()), this, SLOT(onExportPickerCanceled()));
+    filePicker->open();
+}
+
+void ApplicationUI::onCompareOldFileSelected(const QStringList &selectedFiles)
+{
+    pickers::FilePicker *picker = qobject_cast<pickers::FilePicker*>(sender());
+    picker->deleteLater();
+    if(exportDiff_ || selectedFiles.length() < 1 || selectedFiles[0].isEmpty()) { return; }
+    compareOldFileName_ = selectedFiles[0];
+
+    pickers::FilePicker* filePicker = new pickers::FilePicker(this);
+    filePicker->setType(pickers::FileType::Other);
+    filePicker->setMode(pickers::FilePickerMode::Picker);
+    filePicker->setTitle(tr("Select New Export"));
+    connect(filePicker, SIGNAL(fileSelected(QStringList)), this, SLOT(onCompareNewFileSelected(QStringList)), Qt::QueuedConnection);
+    connect(filePicker, SIGNAL(canceled()), this, SLOT(onExportPickerCanceled()));
+    filePicker->open();
+}
+
+void ApplicationUI::onCompareNewFileSelected(const QStringList &selectedFiles)
+{
+    pickers::FilePicker *picker = qobject_cast<pickers::FilePicker*>(sender());
+    picker->deleteLater();
+    if(exportDiff_ || selectedFiles.length() < 1 || selectedFiles[0].isEmpty()) { return; }
+
+    // The differences are saved alongside the new export
+    const QFileInfo oldInfo(compareOldFileName_);
+    const QFileInfo newInfo(selectedFiles[0]);
+    if(oldInfo == newInfo) {
+        bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+        connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+        toast->setBody(tr("Select two different exports to compare"));
+        toast->show();
+        return;
+    }
+    const QString outputFileName = newInfo.absolutePath() + QLatin1Char('/')
+        + newInfo.completeBaseName() + QLatin1String(".diff.jsonl");
+
+    page_->setProperty("activityText", tr("Comparing exports"));
+    page_->setProperty("activityRunning", true);
+
+    QThread *thread = new QThread(this);
+    exportDiff_ = new ExportDiff(oldInfo.absoluteFilePath(), newInfo.absoluteFilePath(), outputFileName);
+    connect(exportDiff_, SIGNAL(finished(bool)), this, SLOT(onCompareFinished(bool)));
+    connect(exportDiff_, SIGNAL(finished(bool)), thread, SLOT(quit()));
+    connect(thread, SIGNAL(started()), exportDiff_, SLOT(start()));
+    connect(thread, SIGNAL(finished()), exportDiff_, SLOT(deleteLater()));
+    connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+    exportDiff_->moveToThread(thread);
+    thread->start();
+}
+
+void ApplicationUI::onCompareFinished(bool success)
+{
+    const QList<ExportDiffEntry> entries = exportDiff_->entries();
+    const int unchangedCount = exportDiff_->unchangedCount();
+    const int malformedCount = exportDiff_->malformedCount();
+    exportDiff_ = NULL;
+    page_->setProperty("activityRunning", false);
+    page_->setProperty("activityText", QString());
+
+    if(!success) {
+        bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+        connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+        toast->setBody(tr("Unable to compare exports"));
+        toast->show();
+        return;
+    }
+
+    QmlDocument *qml = QmlDocument::create("asset:///ReportPage.qml").parent(this);
+    if(qml->hasErrors()) { return; }
+
+    Page *diffPage = qml->createRootObject<Page>();
+    qml->setParent(diffPage);
+    diffPage->setProperty("reportTitle", tr("Export Changes"));
+
+    QVariantList items;
+    int addedCount = 0;
+    int removedCount = 0;
+    int modifiedCount = 0;
+    foreach(const ExportDiffEntry &entry, entries) {
+        QVariantMap map;
+        QString description;
+        switch(entry.change) {
+        case ExportDiffEntry::Added:
+            map["group"] = tr("Added");
+            addedCount++;
+            break;
+        case ExportDiffEntry::Removed:
+            map["group"] = tr("Removed");
+            removedCount++;
+            break;
+        case ExportDiffEntry::Modified:
+        default:
+            map["group"] = tr("Modified");
+            description = tr("+%1 -%2 ~%3 attributes")
+                .arg(entry.addedAttributes).arg(entry.removedAttributes).arg(entry.modifiedAttributes);
+            if(!entry.changedFields.isEmpty()) {
+                description += QLatin1String(", ") + entry.changedFields.join(", ");
+            }
+            modifiedCount++;
             break;
         }
-    } while (true);
+        map["title"] = entry.displayName.isEmpty() ? tr("ID: %1").arg(entry.contactId) : entry.displayName;
+        map["description"] = description;
+        map["status"] = entry.contactId;
+        items.append(map);
+    }
+
+    GroupDataModel *diffModel = new GroupDataModel(QStringList() << "group" << "title", diffPage);
+    diffModel->setGrouping(ItemGrouping::ByFullValue);
+    diffModel->insertList(items);
+    diffPage->findChild<ListView *>("listView")->setDataModel(diffModel);
+
+    QString summary = tr("%1 added, %2 removed, %3 modified, %4 unchanged")
+        .arg(addedCount).arg(removedCount).arg(modifiedCount).arg(unchangedCount);
+    if(malformedCount > 0) {
+        summary += tr(", %1 unreadable lines").arg(malformedCount);
+    }
+    diffPage->setProperty("summary", summary);
+    navPane_->push(diffPage);
+}
+
+void ApplicationUI::onOpenDump()
+{
+    pickers::FilePicker* filePicker = new pickers::FilePicker(this);
+    filePicker->setType(pickers::FileType::Other);
+    filePicker->setMode(pickers::FilePickerMode::Picker);
+    filePicker->setTitle(tr("Open Dump"));
+    connect(filePicker, SIGNAL(fileSelected(QStringList)), this, SLOT(onDumpFileSelected(QStringList)), Qt::QueuedConnection);
+    connect(filePicker, SIGNAL(canceled()), this, SLOT(onExportPickerCanceled()));
+    filePicker->open();
+}
+
+void ApplicationUI::onDumpFileSelected(const QStringList &selectedFiles)
+{
+    pickers::FilePicker *picker = qobject_cast<pickers::FilePicker*>(sender());
+    picker->deleteLater();
+    if(dumpOpener_) { return; }
+    if(selectedFiles.length() < 1 || selectedFiles[0].isEmpty()) { return; }
+
+    page_->setProperty("activityText", tr("Opening dump"));
+    page_->setProperty("activityRunning", true);
+
+    QThread *thread = new QThread(this);
+    dumpOpener_ = new DumpOpener(selectedFiles[0], attributeKindValue, attributeSubKindValue);
+    connect(dumpOpener_, SIGNAL(finished(bool)), this, SLOT(onDumpOpened(bool)));
+    connect(dumpOpener_, SIGNAL(finished(bool)), thread, SLOT(quit()));
+    connect(thread, SIGNAL(started()), dumpOpener_, SLOT(start()));
+    connect(thread, SIGNAL(finished()), dumpOpener_, SLOT(deleteLater()));
+    connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+    dumpOpener_->moveToThread(thread);
+    thread->start();
+}
+
+void ApplicationUI::onDumpOpened(bool success)
+{
+    DumpContactSource *dumpSource = dumpOpener_->takeSource();
+    const QString errorString = dumpOpener_->errorString();
+    dumpOpener_ = NULL;
+    page_->setProperty("activityRunning", false);
+    page_->setProperty("activityText", QString());
+
+    if(!success) {
+        qWarning() << "Unable to open dump:" << errorString;
+
+        bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+        connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+        toast->setBody(tr("Unable to open dump"));
+        toast->show();
+        return;
+    }
+    if(dumpSource->malformedCount() > 0) {
+        qWarning() << "Skipped" << dumpSource->malformedCount() << "lines of the dump";
+    }
+    setContactSource(ContactSourcePointer(dumpSource), true);
+}
+
+void ApplicationUI::onCloseDump()
+{
+    if(!offline_) { return; }
+    setContactSource(serviceSource_, false);
+}
+
+void ApplicationUI::onTraceActionTriggered()
+{
+    if(!Trace::isEnabled()) {
+        Trace::setEnabled(true);
+        traceItem_->setTitle(tr("Save Trace"));
+        return;
+    }
+
+    // Recording stops here, so the trace covers what happened up to now
+    Trace::setEnabled(false);
+    traceItem_->setTitle(tr("Start Tracing"));
+
+    pickers::FilePicker* filePicker = new pickers::FilePicker(this);
+    filePicker->setType(pickers::FileType::Other);
+    filePicker->setMode(pickers::FilePickerMode::Saver);
+    filePicker->setDefaultSaveFileNames(QStringList() << QLatin1String("trace.json"));
+    connect(filePicker, SIGNAL(fileSelected(QStringList)), this, SLOT(onTraceFileSelected(QStringList)), Qt::QueuedConnection);
+    connect(filePicker, SIGNAL(canceled()), this, SLOT(onExportPickerCanceled()));
+    filePicker->open();
+}
+
+void ApplicationUI::onTraceFileSelected(const QStringList &selectedFiles)
+{
+    pickers::FilePicker *picker = qobject_cast<pickers::FilePicker*>(sender());
+    picker->deleteLater();
+    if(selectedFiles.length() < 1 || selectedFiles[0].isEmpty()) { return; }
+
+    QFile file(selectedFiles[0]);
+    bool saved = false;
+    if(file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        saved = Trace::writeChromeTrace(&file);
+        file.close();
+    }
+    if(saved) {
+        file.setPermissions(
+            QFile::ReadOwner | QFile::WriteOwner |
+            QFile::ReadGroup | QFile::WriteGroup |
+            QFile::ReadOther | QFile::WriteOther);
+    }
 
-    emit finished();
+    bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+    connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+    toast->setBody(saved ? tr("Trace saved to file") : tr("Unable to save trace"));
+    toast->show();
 }
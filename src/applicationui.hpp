@@ -5,19 +5,32 @@
 #include <QtCore/QThread>
 #include <QtCore/QList>
 
-#include <bb/pim/contacts/Contact>
 #include <bb/system/SystemUiResult>
 
+#include "contactlistmodel.hpp"
+#include "contactsearchindex.hpp"
+#include "contactlistsnapshot.hpp"
+#include "contactchangemonitor.hpp"
+#include "contactsource.hpp"
+
 namespace bb { namespace cascades {
 class Application;
 class LocaleHandler;
 class NavigationPane;
 class Page;
 class ListView;
-class GroupDataModel;
+class ActionItem;
 }}
 
 class QTranslator;
+class QTimer;
+class ContactsLoader;
+class ContactFilterModel;
+class ContactScanner;
+class DuplicateDetector;
+class ContactStatisticsHandler;
+class ExportDiff;
+class DumpOpener;
 
 class ApplicationUI : public QObject
 {
@@ -32,32 +45,81 @@ private slots:
     void onSheetPageClosed();
     void onOpenUrlInBrowser(const QString &url);
     void onRefreshContactsList();
-    void onContactsPageLoaded(const QList<bb::pim::contacts::Contact> &contactsPage);
-    void onContactsLoadFinished();
+    void onContactsPageLoaded(int generation, const ContactListPage &page);
+    void onFlushPendingContacts();
+    void onContactsLoadFinished(int generation);
+    void onContactsUpdated(const ContactListUpdate &update);
+    void onReloadRequired();
+    void onSaveSnapshot();
+    void onAboutToQuit();
     void onSearch();
     void onSearchPromptFinished(bb::system::SystemUiResult::Type result);
+    void onFilterChanged(const QString &text);
+    void onContactListChanged();
     void onOpenContact(int contactId);
+    void onContactActivated(int contactId);
+    void onExportAll();
+    void onExportBinary();
+    void onExportFileSelected(const QStringList &selectedFiles);
+    void onExportPickerCanceled();
+    void onExportProgress(int contactCount);
+    void onExportFinished(bool success);
+    void onFindDuplicates();
+    void onDuplicatesFinished(bool success);
+    void onShowStatistics();
+    void onStatisticsFinished(bool success);
+    void onScanProgress(int contactCount);
+    void onCompareExports();
+    void onCompareOldFileSelected(const QStringList &selectedFiles);
+    void onCompareNewFileSelected(const QStringList &selectedFiles);
+    void onCompareFinished(bool success);
+    void onOpenDump();
+    void onDumpFileSelected(const QStringList &selectedFiles);
+    void onDumpOpened(bool success);
+    void onCloseDump();
+    void onTraceActionTriggered();
+    void onTraceFileSelected(const QStringList &selectedFiles);
 private:
+    void startLoad(bool reconcile);
+    void reconcileContacts();
+    void saveSnapshot();
+    void savePendingSnapshot();
+    void setContactSource(const ContactSourcePointer &source, bool offline);
     QTranslator *translator_;
     bb::cascades::LocaleHandler *localeHandler_;
     bb::cascades::NavigationPane *navPane_;
     bb::cascades::Page *page_;
     bb::cascades::ListView *listView_;
-    bb::cascades::GroupDataModel *dataModel_;
+    bb::cascades::ActionItem *traceItem_;
+    ContactSourcePointer contactSource_;
+    ContactSourcePointer serviceSource_;
+    bool offline_;
+    ContactListModel *dataModel_;
+    ContactFilterModel *filterModel_;
     QThread *loadThread_;
-};
-
-class ContactsLoader : public QObject
-{
-    Q_OBJECT
-public:
-    ContactsLoader(QObject *parent=0);
-    virtual ~ContactsLoader() { }
-public slots:
-    void start();
-signals:
-    void pageLoaded(const QList<bb::pim::contacts::Contact> &contactsPage);
-    void finished();
+    ContactsLoader *loader_;
+    QList<ContactListEntry> pendingEntries_;
+    QList<int> pendingPageSizes_;
+    qint64 pendingMsecs_;
+    int loadGeneration_;
+    ContactChangeMonitor *changeMonitor_;
+    ContactListSnapshot snapshot_;
+    QTimer *snapshotTimer_;
+    bool reconciling_;
+    QList<ContactListEntry> reconcileEntries_;
+    ContactSearchIndex searchIndex_;
+    QString searchText_;
+    QList<int> searchMatches_;
+    int searchPosition_;
+    QString filterText_;
+    ContactScanner *exportScanner_;
+    ContactScanner *duplicateScanner_;
+    DuplicateDetector *duplicateDetector_;
+    ContactScanner *statisticsScanner_;
+    ContactStatisticsHandler *statisticsHandler_;
+    ExportDiff *exportDiff_;
+    QString compareOldFileName_;
+    DumpOpener *dumpOpener_;
 };
 
 #endif // APPLICATIONUI_HPP
@@ -0,0 +1,254 @@
+#include "attributenames.hpp"
+
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+
+namespace
+{
+// Values below this are looked up by array index
+const int DenseValueLimit = 1024;
+
+struct NameEntry
+{
+    int value;
+    const char *name;
+};
+
+#define KIND(x) { bb::pim::contacts::AttributeKind::x, #x }
+#define SUBKIND(x) { bb::pim::contacts::AttributeSubKind::x, #x }
+
+const NameEntry kindEntries[] = {
+    KIND(Invalid),
+    KIND(Phone),
+    KIND(Fax),
+    KIND(Pager),
+    KIND(Email),
+    KIND(Website),
+    KIND(Feed),
+    KIND(Profile),
+    KIND(Family),
+    KIND(Person),
+    KIND(Date),
+    KIND(Group),
+    KIND(Name),
+    KIND(StockSymbol),
+    KIND(Ranking),
+    KIND(OrganizationAffiliation),
+    KIND(Education),
+    KIND(Note),
+    KIND(InstantMessaging),
+    KIND(VideoChat),
+    KIND(ConnectionCount),
+    KIND(Hidden),
+    KIND(Biography),
+    KIND(Sound),
+    KIND(Notification),
+    KIND(MessageSound),
+    KIND(MessageNotification)
+};
+
+const NameEntry subKindEntries[] = {
+    SUBKIND(Invalid),
+    SUBKIND(Other),
+    SUBKIND(Home),
+    SUBKIND(Work),
+    SUBKIND(PhoneMobile),
+    SUBKIND(FaxDirect),
+    SUBKIND(Blog),
+    SUBKIND(WebsiteResume),
+    SUBKIND(WebsitePortfolio),
+    SUBKIND(WebsitePersonal),
+    SUBKIND(WebsiteCompany),
+    SUBKIND(ProfileFacebook),
+    SUBKIND(ProfileTwitter),
+    SUBKIND(ProfileLinkedIn),
+    SUBKIND(ProfileGist),
+    SUBKIND(ProfileTungle),
+    SUBKIND(FamilySpouse),
+    SUBKIND(FamilyChild),
+    SUBKIND(FamilyParent),
+    SUBKIND(PersonManager),
+    SUBKIND(PersonAssistant),
+    SUBKIND(DateBirthday),
+    SUBKIND(DateAnniversary),
+    SUBKIND(GroupDepartment),
+    SUBKIND(NameGiven),
+    SUBKIND(NameSurname),
+    SUBKIND(Title),
+    SUBKIND(NameSuffix),
+    SUBKIND(NameMiddle),
+    SUBKIND(NameNickname),
+    SUBKIND(NameAlias),
+    SUBKIND(NameDisplayName),
+    SUBKIND(NamePhoneticGiven),
+    SUBKIND(NamePhoneticSurname),
+    SUBKIND(StockSymbolNyse),
+    SUBKIND(StockSymbolNasdaq),
+    SUBKIND(StockSymbolTse),
+    SUBKIND(StockSymbolLse),
+    SUBKIND(StockSymbolTsx),
+    SUBKIND(RankingKlout),
+    SUBKIND(RankingTrstRank),
+    SUBKIND(OrganizationAffiliationName),
+    SUBKIND(OrganizationAffiliationPhoneticName),
+    SUBKIND(StartDate),
+    SUBKIND(EndDate),
+    SUBKIND(OrganizationAffiliationDetails),
+    SUBKIND(EducationInstitutionName),
+    SUBKIND(EducationDegree),
+    SUBKIND(EducationConcentration),
+    SUBKIND(EducationActivities),
+    SUBKIND(EducationNotes),
+    SUBKIND(InstantMessagingBbmPin),
+    SUBKIND(InstantMessagingAim),
+    SUBKIND(InstantMessagingAliwangwang),
+    SUBKIND(InstantMessagingGoogleTalk),
+    SUBKIND(InstantMessagingSametime),
+    SUBKIND(InstantMessagingIcq),
+    SUBKIND(InstantMessagingIrc),
+    SUBKIND(InstantMessagingJabber),
+    SUBKIND(InstantMessagingMsLcs),
+    SUBKIND(InstantMessagingMsn),
+    SUBKIND(InstantMessagingQq),
+    SUBKIND(InstantMessagingSkype),
+    SUBKIND(InstantMessagingYahooMessenger),
+    SUBKIND(InstantMessagingYahooMessengerJapan),
+    SUBKIND(VideoChatBbPlaybook),
+    SUBKIND(HiddenLinkedIn),
+    SUBKIND(HiddenFacebook),
+    SUBKIND(HiddenTwitter),
+    SUBKIND(ConnectionCountLinkedIn),
+    SUBKIND(ConnectionCountFacebook),
+    SUBKIND(ConnectionCountTwitter),
+    SUBKIND(HiddenChecksum),
+    SUBKIND(HiddenSpeedDial),
+    SUBKIND(BiographyFacebook),
+    SUBKIND(BiographyTwitter),
+    SUBKIND(BiographyLinkedIn),
+    SUBKIND(SoundRingtone),
+    SUBKIND(SimContactType),
+    SUBKIND(EcoID),
+    SUBKIND(Personal),
+    SUBKIND(StockSymbolAll),
+    SUBKIND(NotificationVibration),
+    SUBKIND(NotificationLED),
+    SUBKIND(MessageNotificationVibration),
+    SUBKIND(MessageNotificationLED),
+    SUBKIND(MessageNotificationDuringCall),
+    SUBKIND(VideoChatPin),
+    SUBKIND(NamePrefix),
+    SUBKIND(Business),
+    SUBKIND(ProfileSinaWeibo),
+    SUBKIND(HiddenSinaWeibo),
+    SUBKIND(ConnectionCountSinaWeibo),
+    SUBKIND(BiographySinaWeibo),
+    SUBKIND(DeviceInfo)
+};
+
+#undef KIND
+#undef SUBKIND
+
+class NameTable
+{
+public:
+    NameTable(const NameEntry *entries, int count)
+    {
+        int maxValue = -1;
+        for(int i = 0; i < count; i++) {
+            if(entries[i].value < DenseValueLimit) {
+                maxValue = qMax(maxValue, entries[i].value);
+            }
+        }
+
+        names_.resize(maxValue + 1);
+        for(int i = 0; i < count; i++) {
+            const QString name = QLatin1String(entries[i].name);
+            if(entries[i].value >= 0 && entries[i].value < DenseValueLimit) {
+                names_[entries[i].value] = name;
+            }
+            else {
+                sparseNames_.insert(entries[i].value, name);
+            }
+            values_.insert(name, entries[i].value);
+        }
+    }
+
+    QString name(int value) const
+    {
+        if(value >= 0 && value < names_.size()) {
+            return names_[value];
+        }
+        return sparseNames_.value(value);
+    }
+
+    int value(const QString &name, bool *ok) const
+    {
+        QHash<QString, int>::const_iterator it = values_.constFind(name);
+        if(ok) { *ok = (it != values_.constEnd()); }
+        return (it != values_.constEnd()) ? it.value() : 0;
+    }
+
+private:
+    QVector<QString> names_;
+    QHash<int, QString> sparseNames_;
+    QHash<QString, int> values_;
+};
+
+class AttributeNameTables
+{
+public:
+    AttributeNameTables()
+        : kinds(kindEntries, sizeof(kindEntries) / sizeof(kindEntries[0])),
+          subKinds(subKindEntries, sizeof(subKindEntries) / sizeof(subKindEntries[0])) { }
+    const NameTable kinds;
+    const NameTable subKinds;
+};
+
+Q_GLOBAL_STATIC(AttributeNameTables, nameTables)
+
+/**
+ * Looks up a name in a table, also accepting the "Prefix (n)" form used
+ * for values missing from the tables.
+ */
+int lookupValue(const NameTable &table, const char *prefix, const QString &name, bool *ok)
+{
+    bool found = false;
+    int value = table.value(name, &found);
+    const int prefixLength = qstrlen(prefix);
+    if(!found && name.startsWith(QLatin1String(prefix)) && name.endsWith(QLatin1Char(')'))) {
+        value = name.mid(prefixLength, name.length() - prefixLength - 1).toInt(&found);
+    }
+    if(ok) { *ok = found; }
+    return found ? value : 0;
+}
+}
+
+QString AttributeNames::kindName(bb::pim::contacts::AttributeKind::Type kind)
+{
+    const QString name = nameTables()->kinds.name(kind);
+    if(name.isNull()) {
+        return QString("Kind (%1)").arg(kind);
+    }
+    return name;
+}
+
+QString AttributeNames::subKindName(bb::pim::contacts::AttributeSubKind::Type subKind)
+{
+    const QString name = nameTables()->subKinds.name(subKind);
+    if(name.isNull()) {
+        return QString("SubKind (%1)").arg(subKind);
+    }
+    return name;
+}
+
+bb::pim::contacts::AttributeKind::Type AttributeNames::kind(const QString &name, bool *ok)
+{
+    return static_cast<bb::pim::contacts::AttributeKind::Type>(
+        lookupValue(nameTables()->kinds, "Kind (", name, ok));
+}
+
+bb::pim::contacts::AttributeSubKind::Type AttributeNames::subKind(const QString &name, bool *ok)
+{
+    return static_cast<bb::pim::contacts::AttributeSubKind::Type>(
+        lookupValue(nameTables()->subKinds, "SubKind (", name, ok));
+}
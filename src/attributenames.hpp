@@ -0,0 +1,27 @@
+#ifndef ATTRIBUTENAMES_HPP
+#define ATTRIBUTENAMES_HPP
+
+#include <QtCore/QString>
+
+#include <bb/pim/contacts/ContactAttribute>
+
+/**
+ * Names of contact attribute kinds and sub-kinds, as used for display and
+ * in exported contact data.
+ *
+ * Names come from static tables and are returned as shared strings, so
+ * looking one up does not allocate. Values missing from the tables are
+ * formatted as "Kind (n)" or "SubKind (n)", and both forms are accepted
+ * when parsing exported names back into values.
+ */
+class AttributeNames
+{
+public:
+    static QString kindName(bb::pim::contacts::AttributeKind::Type kind);
+    static QString subKindName(bb::pim::contacts::AttributeSubKind::Type subKind);
+
+    static bb::pim::contacts::AttributeKind::Type kind(const QString &name, bool *ok=0);
+    static bb::pim::contacts::AttributeSubKind::Type subKind(const QString &name, bool *ok=0);
+};
+
+#endif // ATTRIBUTENAMES_HPP
@@ -0,0 +1,489 @@
+#include "binaryexport.hpp"
+
+#include <QtCore/QDebug>
+#include <QtCore/QIODevice>
+#include <QtCore/QMap>
+
+#include "contactexporter.hpp"
+#include "jsonwriter.hpp"
+
+namespace
+{
+const char Magic[] = "CIBX";
+const int MagicLength = 4;
+const quint64 FormatVersion = 1;
+
+// Blocks hold a page of contacts, so anything larger is corrupt
+const quint64 MaximumBlockLength = 64 * 1024 * 1024;
+
+// Flags of a photo
+const int PrimaryPhoto = 0x01;
+
+void writeVarint(QByteArray &data, quint64 value)
+{
+    while(value >= 0x80) {
+        data.append(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data.append(char(value));
+}
+
+void writeInt(QByteArray &data, int value)
+{
+    writeVarint(data, quint32(value));
+}
+
+/**
+ * Writes the difference between two IDs, zigzag encoded so that small
+ * negative differences stay small.
+ */
+void writeDelta(QByteArray &data, qint64 value, qint64 *previous)
+{
+    const qint64 delta = value - *previous;
+    *previous = value;
+    writeVarint(data, (quint64(delta) << 1) ^ quint64(delta >> 63));
+}
+
+qint64 readDelta(quint64 value, qint64 *previous)
+{
+    *previous += qint64(value >> 1) ^ -qint64(value & 1);
+    return *previous;
+}
+
+/**
+ * Strings used by a block, by index. Index 0 is the empty string, and is
+ * never written.
+ */
+class StringTable
+{
+public:
+    int index(const QString &str)
+    {
+        if(str.isEmpty()) { return 0; }
+        QHash<QString, int>::const_iterator it = indexes_.constFind(str);
+        if(it != indexes_.constEnd()) {
+            return it.value();
+        }
+        strings_.append(str);
+        indexes_.insert(str, strings_.size());
+        return strings_.size();
+    }
+
+    void write(QByteArray &data) const
+    {
+        writeInt(data, strings_.size());
+        foreach(const QString &str, strings_) {
+            const QByteArray utf8 = str.toUtf8();
+            writeInt(data, utf8.size());
+            data.append(utf8);
+        }
+    }
+
+private:
+    QHash<QString, int> indexes_;
+    QList<QString> strings_;
+};
+
+void writeString(QByteArray &data, StringTable &strings, const QString &str)
+{
+    writeInt(data, strings.index(str));
+}
+
+void writeNames(QByteArray &data, const QMap<int, int> &names)
+{
+    writeInt(data, names.size());
+    for(QMap<int, int>::const_iterator it = names.constBegin(); it != names.constEnd(); ++it) {
+        writeInt(data, it.key());
+        writeInt(data, it.value());
+    }
+}
+}
+
+QByteArray BinaryExporter::fileHeader()
+{
+    QByteArray data(Magic, MagicLength);
+    writeVarint(data, FormatVersion);
+    return data;
+}
+
+QByteArray BinaryExporter::fileTrailer()
+{
+    QByteArray data;
+    writeVarint(data, 0);
+    return data;
+}
+
+QByteArray BinaryExporter::encodeBlock(const QList<ContactRecord> &contacts)
+{
+    if(contacts.isEmpty()) { return QByteArray(); }
+
+    StringTable strings;
+    QMap<int, int> kindNames;
+    QMap<int, int> subKindNames;
+    qint64 previousContactId = 0;
+    qint64 previousAttributeId = 0;
+    qint64 previousPhotoId = 0;
+
+    QByteArray body;
+    writeInt(body, contacts.size());
+    foreach(const ContactRecord &contact, contacts) {
+        writeDelta(body, contact.id, &previousContactId);
+        writeInt(body, contact.accountId);
+        writeString(body, strings, contact.displayCompanyName);
+        writeString(body, strings, contact.displayName);
+
+        writeInt(body, contact.attributes.size());
+        foreach(const ContactRecordAttribute &attribute, contact.attributes) {
+            writeDelta(body, attribute.id, &previousAttributeId);
+            if(!kindNames.contains(attribute.kind)) {
+                kindNames.insert(attribute.kind, strings.index(attribute.kindName));
+            }
+            if(!subKindNames.contains(attribute.subKind)) {
+                subKindNames.insert(attribute.subKind, strings.index(attribute.subKindName));
+            }
+            writeInt(body, attribute.kind);
+            writeInt(body, attribute.subKind);
+            writeString(body, strings, attribute.value);
+            writeInt(body, attribute.sources.size());
+            foreach(int source, attribute.sources) {
+                writeInt(body, source);
+            }
+        }
+
+        writeInt(body, contact.photos.size());
+        foreach(const ContactRecordPhoto &photo, contact.photos) {
+            writeDelta(body, photo.id, &previousPhotoId);
+            writeInt(body, photo.sourceAccountId);
+            writeInt(body, photo.id == contact.primaryPhotoId ? PrimaryPhoto : 0);
+        }
+
+        writeInt(body, contact.sourceAccounts.size());
+        foreach(const ContactRecordAccount &account, contact.sourceAccounts) {
+            writeInt(body, account.id);
+            writeString(body, strings, account.displayName);
+            writeString(body, strings, account.providerId);
+            writeString(body, strings, account.providerName);
+        }
+    }
+
+    QByteArray block;
+    strings.write(block);
+    writeNames(block, kindNames);
+    writeNames(block, subKindNames);
+    block.append(body);
+
+    QByteArray data;
+    data.reserve(block.size() + 5);
+    writeVarint(data, block.size());
+    data.append(block);
+    return data;
+}
+
+BinaryExportReader::BinaryExportReader(QIODevice *device)
+    : device_(device), pos_(NULL), end_(NULL), contactsLeft_(0),
+    previousContactId_(0), previousAttributeId_(0), previousPhotoId_(0),
+    headerRead_(false), finished_(false), error_(false)
+{
+}
+
+bool BinaryExportReader::readContact(ContactRecord *contact)
+{
+    if(error_) { return false; }
+    if(!headerRead_ && !readHeader()) { return false; }
+
+    while(contactsLeft_ == 0) {
+        if(finished_ || !readBlock()) { return false; }
+    }
+    contactsLeft_--;
+
+    *contact = ContactRecord();
+    if(!decodeContact(contact)) {
+        return setError(QLatin1String("Malformed contact data"));
+    }
+    if(contactsLeft_ == 0 && pos_ != end_) {
+        return setError(QLatin1String("Unexpected data at the end of a block"));
+    }
+    return true;
+}
+
+bool BinaryExportReader::convertToJson(QIODevice *input, QIODevice *output, QString *errorString)
+{
+    BinaryExportReader reader(input);
+    JsonWriter writer(output);
+    ContactRecord contact;
+    while(reader.readContact(&contact)) {
+        ContactExporter::writeContact(writer, contact);
+        writer.endLine();
+    }
+
+    bool success = !reader.hasError();
+    if(!writer.flush()) {
+        reader.setError(output->errorString());
+        success = false;
+    }
+    if(errorString) {
+        *errorString = reader.errorString();
+    }
+    return success;
+}
+
+bool BinaryExportReader::readHeader()
+{
+    headerRead_ = true;
+    if(device_->read(MagicLength) != QByteArray(Magic, MagicLength)) {
+        return setError(QLatin1String("Not a binary contact export"));
+    }
+    quint64 version;
+    if(!readDeviceVarint(&version)) {
+        return setError(QLatin1String("Truncated export header"));
+    }
+    if(version != FormatVersion) {
+        return setError(QString("Unsupported export version %1").arg(version));
+    }
+    return true;
+}
+
+bool BinaryExportReader::readBlock()
+{
+    quint64 length;
+    if(!readDeviceVarint(&length)) {
+        return setError(QLatin1String("Truncated export"));
+    }
+    if(length == 0) {
+        finished_ = true;
+        return false;
+    }
+    if(length > MaximumBlockLength) {
+        return setError(QLatin1String("Malformed block length"));
+    }
+
+    block_ = device_->read(qint64(length));
+    if(quint64(block_.size()) != length) {
+        return setError(QLatin1String("Truncated export"));
+    }
+    pos_ = reinterpret_cast<const uchar *>(block_.constData());
+    end_ = pos_ + block_.size();
+
+    // IDs are relative to the previous ones within the same block
+    previousContactId_ = 0;
+    previousAttributeId_ = 0;
+    previousPhotoId_ = 0;
+
+    int stringCount;
+    if(!decodeInt(&stringCount) || stringCount < 0 || stringCount > end_ - pos_) {
+        return setError(QLatin1String("Malformed string table"));
+    }
+    strings_.resize(stringCount + 1);
+    strings_[0] = QString();
+    for(int i = 1; i <= stringCount; i++) {
+        int size;
+        if(!decodeInt(&size) || size < 0 || size > end_ - pos_) {
+            return setError(QLatin1String("Malformed string table"));
+        }
+        strings_[i] = QString::fromUtf8(reinterpret_cast<const char *>(pos_), size);
+        pos_ += size;
+    }
+
+    if(!decodeNames(&kindNames_) || !decodeNames(&subKindNames_)) {
+        return setError(QLatin1String("Malformed kind table"));
+    }
+    if(!decodeInt(&contactsLeft_) || contactsLeft_ <= 0) {
+        return setError(QLatin1String("Malformed block"));
+    }
+    return true;
+}
+
+bool BinaryExportReader::readDeviceVarint(quint64 *value)
+{
+    *value = 0;
+    for(int shift = 0; shift < 64; shift += 7) {
+        char c;
+        if(!device_->getChar(&c)) { return false; }
+        *value |= quint64(uchar(c) & 0x7F) << shift;
+        if(!(uchar(c) & 0x80)) { return true; }
+    }
+    return false;
+}
+
+bool BinaryExportReader::decodeVarint(quint64 *value)
+{
+    *value = 0;
+    for(int shift = 0; shift < 64 && pos_ < end_; shift += 7) {
+        const uchar c = *pos_++;
+        *value |= quint64(c & 0x7F) << shift;
+        if(!(c & 0x80)) { return true; }
+    }
+    return false;
+}
+
+bool BinaryExportReader::decodeInt(int *value)
+{
+    quint64 data;
+    if(!decodeVarint(&data) || data > Q_UINT64_C(0xFFFFFFFF)) { return false; }
+    *value = int(quint32(data));
+    return true;
+}
+
+bool BinaryExportReader::decodeString(QString *value)
+{
+    int index;
+    if(!decodeInt(&index) || index < 0 || index >= strings_.size()) { return false; }
+    *value = strings_[index];
+    return true;
+}
+
+bool BinaryExportReader::decodeNames(QHash<int, QString> *names)
+{
+    names->clear();
+    int count;
+    if(!decodeInt(&count) || count < 0) { return false; }
+    for(int i = 0; i < count; i++) {
+        int value;
+        QString name;
+        if(!decodeInt(&value) || !decodeString(&name)) { return false; }
+        names->insert(value, name);
+    }
+    return true;
+}
+
+bool BinaryExportReader::decodeAttribute(ContactRecordAttribute *attribute)
+{
+    quint64 id;
+    int sourceCount;
+    if(!decodeVarint(&id)
+        || !decodeInt(&attribute->kind)
+        || !decodeInt(&attribute->subKind)
+        || !decodeString(&attribute->value)
+        || !decodeInt(&sourceCount) || sourceCount < 0) {
+        return false;
+    }
+    attribute->id = int(readDelta(id, &previousAttributeId_));
+    attribute->kindName = kindNames_.value(attribute->kind);
+    attribute->subKindName = subKindNames_.value(attribute->subKind);
+    for(int i = 0; i < sourceCount; i++) {
+        int source;
+        if(!decodeInt(&source)) { return false; }
+        attribute->sources.append(source);
+    }
+    return true;
+}
+
+bool BinaryExportReader::decodeContact(ContactRecord *contact)
+{
+    quint64 id;
+    int attributeCount;
+    if(!decodeVarint(&id)
+        || !decodeInt(&contact->accountId)
+        || !decodeString(&contact->displayCompanyName)
+        || !decodeString(&contact->displayName)
+        || !decodeInt(&attributeCount) || attributeCount < 0) {
+        return false;
+    }
+    contact->id = int(readDelta(id, &previousContactId_));
+
+    for(int i = 0; i < attributeCount; i++) {
+        ContactRecordAttribute attribute;
+        if(!decodeAttribute(&attribute)) { return false; }
+        contact->attributes.append(attribute);
+    }
+
+    int photoCount;
+    if(!decodeInt(&photoCount) || photoCount < 0) { return false; }
+    for(int i = 0; i < photoCount; i++) {
+        ContactRecordPhoto photo;
+        int flags;
+        if(!decodeVarint(&id) || !decodeInt(&photo.sourceAccountId) || !decodeInt(&flags)) {
+            return false;
+        }
+        photo.id = int(readDelta(id, &previousPhotoId_));
+        if(flags & PrimaryPhoto) {
+            contact->primaryPhotoId = photo.id;
+        }
+        contact->photos.append(photo);
+    }
+
+    int accountCount;
+    if(!decodeInt(&accountCount) || accountCount < 0) { return false; }
+    for(int i = 0; i < accountCount; i++) {
+        ContactRecordAccount account;
+        if(!decodeInt(&account.id)
+            || !decodeString(&account.displayName)
+            || !decodeString(&account.providerId)
+            || !decodeString(&account.providerName)) {
+            return false;
+        }
+        contact->sourceAccounts.append(account);
+    }
+    return true;
+}
+
+bool BinaryExportReader::setError(const QString &errorString)
+{
+    error_ = true;
+    errorString_ = errorString;
+    return false;
+}
+
+BinaryExportHandler::BinaryExportHandler(const QString &fileName) : file_(fileName)
+{
+}
+
+BinaryExportHandler::~BinaryExportHandler()
+{
+}
+
+QByteArray BinaryExportHandler::processPage(const QList<ContactRecord> &contacts)
+{
+    return BinaryExporter::encodeBlock(contacts);
+}
+
+bool BinaryExportHandler::consumePage(const QByteArray &result)
+{
+    if(!openFile()) { return false; }
+    if(file_.write(result) != result.size()) {
+        qWarning() << "Unable to write export data:" << file_.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool BinaryExportHandler::finish(bool success)
+{
+    // The trailer marks the export as complete, so a partial export is
+    // removed rather than left looking like a valid one
+    if(success && openFile()) {
+        const QByteArray trailer = BinaryExporter::fileTrailer();
+        success = file_.write(trailer) == trailer.size();
+        if(!success) {
+            qWarning() << "Unable to write export data:" << file_.errorString();
+        }
+    }
+    else {
+        success = false;
+    }
+    if(!success) {
+        file_.remove();
+        return false;
+    }
+    file_.close();
+    file_.setPermissions(
+        QFile::ReadOwner | QFile::WriteOwner |
+        QFile::ReadGroup | QFile::WriteGroup |
+        QFile::ReadOther | QFile::WriteOther);
+    return success;
+}
+
+bool BinaryExportHandler::openFile()
+{
+    if(file_.isOpen()) { return true; }
+    if(!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Unable to open file for writing:" << file_.errorString();
+        return false;
+    }
+    const QByteArray header = BinaryExporter::fileHeader();
+    if(file_.write(header) != header.size()) {
+        qWarning() << "Unable to write export data:" << file_.errorString();
+        return false;
+    }
+    return true;
+}
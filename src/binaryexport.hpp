@@ -0,0 +1,106 @@
+#ifndef BINARYEXPORT_HPP
+#define BINARYEXPORT_HPP
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
+#include "contactrecord.hpp"
+#include "contactscanner.hpp"
+
+class QIODevice;
+
+/**
+ * Writes contacts in a compact binary form of the export format.
+ *
+ * A file starts with the magic bytes "CIBX" and a format version, and is
+ * followed by blocks of contacts, each prefixed with its length, up to an
+ * empty block. Every block starts with a table of the strings it uses and
+ * the names of its attribute kinds and sub-kinds, so contacts refer to
+ * strings by index and to kinds by their numeric values. Numbers are
+ * written as varints, with IDs as the difference from the previous one.
+ *
+ * Blocks are independent of each other, which lets pages of contacts be
+ * encoded concurrently, and lets readers decode one block at a time.
+ */
+class BinaryExporter
+{
+public:
+    static QByteArray fileHeader();
+    static QByteArray fileTrailer();
+    static QByteArray encodeBlock(const QList<ContactRecord> &contacts);
+};
+
+/**
+ * Reads contacts back from a binary export, one at a time, with only the
+ * current block held in memory.
+ */
+class BinaryExportReader
+{
+public:
+    explicit BinaryExportReader(QIODevice *device);
+
+    /**
+     * Reads the next contact, returning false at the end of the export or
+     * if it is malformed.
+     */
+    bool readContact(ContactRecord *contact);
+
+    bool hasError() const { return error_; }
+    QString errorString() const { return errorString_; }
+
+    /**
+     * Converts a binary export to the JSON Lines export format, as written
+     * by BulkExportHandler.
+     */
+    static bool convertToJson(QIODevice *input, QIODevice *output, QString *errorString=0);
+
+private:
+    bool readHeader();
+    bool readBlock();
+    bool readDeviceVarint(quint64 *value);
+    bool decodeVarint(quint64 *value);
+    bool decodeInt(int *value);
+    bool decodeString(QString *value);
+    bool decodeNames(QHash<int, QString> *names);
+    bool decodeAttribute(ContactRecordAttribute *attribute);
+    bool decodeContact(ContactRecord *contact);
+    bool setError(const QString &errorString);
+
+    QIODevice *device_;
+    QByteArray block_;
+    const uchar *pos_;
+    const uchar *end_;
+    QVector<QString> strings_;
+    QHash<int, QString> kindNames_;
+    QHash<int, QString> subKindNames_;
+    int contactsLeft_;
+    qint64 previousContactId_;
+    qint64 previousAttributeId_;
+    qint64 previousPhotoId_;
+    bool headerRead_;
+    bool finished_;
+    bool error_;
+    QString errorString_;
+};
+
+/**
+ * Scan handler that exports every contact to a binary export file, with
+ * one block per page. Pages are encoded on the scanner's worker threads
+ * and appended to the file in order.
+ */
+class BinaryExportHandler : public ContactScanHandler
+{
+public:
+    BinaryExportHandler(const QString &fileName);
+    virtual ~BinaryExportHandler();
+    virtual QByteArray processPage(const QList<ContactRecord> &contacts);
+    virtual bool consumePage(const QByteArray &result);
+    virtual bool finish(bool success);
+private:
+    bool openFile();
+    QFile file_;
+};
+
+#endif // BINARYEXPORT_HPP
@@ -0,0 +1,185 @@
+#include "contactchangemonitor.hpp"
+
+#include <QtCore/QTimer>
+#include <QtCore/QThread>
+
+#include <bb/pim/contacts/ContactService>
+
+using namespace bb::pim::contacts;
+
+namespace
+{
+// Quiet period after the last notification before a batch is processed
+const int FlushDelayMsecs = 500;
+
+// Longest a change waits while notifications keep arriving, such as
+// during an account sync
+const int MaximumFlushLatencyMsecs = 2000;
+
+// Beyond this many contacts a full reload is cheaper than patching
+const int MaximumUpdateSize = 2000;
+}
+
+ContactChangeMonitor::ContactChangeMonitor(const ContactSourcePointer &source, QObject *parent)
+    : QObject(parent), source_(source), resetPending_(false), paused_(false), loading_(false)
+{
+    qRegisterMetaType<ContactListUpdate>("ContactListUpdate");
+
+    flushTimer_ = new QTimer(this);
+    flushTimer_->setSingleShot(true);
+    flushTimer_->setInterval(FlushDelayMsecs);
+    connect(flushTimer_, SIGNAL(timeout()), this, SLOT(onFlushChanges()));
+
+    // Only used for its change notifications, the contacts themselves are
+    // read from the source.
+    contactService_ = new ContactService(this);
+    connect(contactService_, SIGNAL(contactsAdded(QList<bb::pim::contacts::ContactId>)),
+        this, SLOT(onContactsAdded(QList<bb::pim::contacts::ContactId>)));
+    connect(contactService_, SIGNAL(contactsChanged(QList<bb::pim::contacts::ContactId>)),
+        this, SLOT(onContactsChanged(QList<bb::pim::contacts::ContactId>)));
+    connect(contactService_, SIGNAL(contactsDeleted(QList<bb::pim::contacts::ContactId>)),
+        this, SLOT(onContactsDeleted(QList<bb::pim::contacts::ContactId>)));
+    connect(contactService_, SIGNAL(contactsReset()), this, SLOT(onContactsReset()));
+}
+
+ContactChangeMonitor::~ContactChangeMonitor()
+{
+}
+
+void ContactChangeMonitor::setPaused(bool paused)
+{
+    paused_ = paused;
+    if(paused_) {
+        flushTimer_->stop();
+    }
+    else {
+        scheduleFlush();
+    }
+}
+
+void ContactChangeMonitor::onContactsAdded(const QList<ContactId> &contactIds)
+{
+    foreach(ContactId contactId, contactIds) {
+        deletedIds_.remove(contactId);
+        changedIds_.insert(contactId);
+    }
+    scheduleFlush();
+}
+
+void ContactChangeMonitor::onContactsChanged(const QList<ContactId> &contactIds)
+{
+    foreach(ContactId contactId, contactIds) {
+        if(!deletedIds_.contains(contactId)) {
+            changedIds_.insert(contactId);
+        }
+    }
+    scheduleFlush();
+}
+
+void ContactChangeMonitor::onContactsDeleted(const QList<ContactId> &contactIds)
+{
+    foreach(ContactId contactId, contactIds) {
+        changedIds_.remove(contactId);
+        deletedIds_.insert(contactId);
+    }
+    scheduleFlush();
+}
+
+void ContactChangeMonitor::onContactsReset()
+{
+    resetPending_ = true;
+    scheduleFlush();
+}
+
+void ContactChangeMonitor::scheduleFlush()
+{
+    // Each notification pushes the flush back, so a burst of them is
+    // handled as one batch, but never past the maximum latency counted
+    // from the oldest pending change.
+    if(resetPending_ || !changedIds_.isEmpty() || !deletedIds_.isEmpty()) {
+        if(!pendingTimer_.isValid()) {
+            pendingTimer_.start();
+        }
+    }
+    else {
+        pendingTimer_.invalidate();
+        return;
+    }
+    if(paused_ || loading_) { return; }
+
+    const qint64 remainingMsecs = MaximumFlushLatencyMsecs - pendingTimer_.elapsed();
+    flushTimer_->start(int(qBound(qint64(0), remainingMsecs, qint64(FlushDelayMsecs))));
+}
+
+void ContactChangeMonitor::onFlushChanges()
+{
+    if(paused_ || loading_) { return; }
+    pendingTimer_.invalidate();
+
+    if(resetPending_ || changedIds_.size() + deletedIds_.size() > MaximumUpdateSize) {
+        resetPending_ = false;
+        changedIds_.clear();
+        deletedIds_.clear();
+        emit reloadRequired();
+        return;
+    }
+    if(changedIds_.isEmpty() && deletedIds_.isEmpty()) { return; }
+
+    loading_ = true;
+    QThread *thread = new QThread(this);
+    ContactUpdateLoader *loader = new ContactUpdateLoader(source_, changedIds_.toList(), deletedIds_.toList());
+    changedIds_.clear();
+    deletedIds_.clear();
+    connect(loader, SIGNAL(updateLoaded(ContactListUpdate)), this, SLOT(onUpdateLoaded(ContactListUpdate)));
+    connect(loader, SIGNAL(finished()), this, SLOT(onUpdateFinished()));
+    connect(loader, SIGNAL(finished()), thread, SLOT(quit()));
+    connect(thread, SIGNAL(started()), loader, SLOT(start()));
+    connect(thread, SIGNAL(finished()), loader, SLOT(deleteLater()));
+    connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+    loader->moveToThread(thread);
+    thread->start();
+}
+
+void ContactChangeMonitor::onUpdateLoaded(const ContactListUpdate &update)
+{
+    // A batch that completes after monitoring was paused is held back
+    // along with the other changes collected in the meantime.
+    if(paused_) {
+        foreach(const ContactListEntry &entry, update.entries) {
+            changedIds_.insert(entry.contactId);
+        }
+        foreach(int contactId, update.removedContactIds) {
+            deletedIds_.insert(contactId);
+        }
+        return;
+    }
+    emit contactsUpdated(update);
+}
+
+void ContactChangeMonitor::onUpdateFinished()
+{
+    loading_ = false;
+    scheduleFlush();
+}
+
+ContactUpdateLoader::ContactUpdateLoader(const ContactSourcePointer &source, const QList<int> &changedIds,
+    const QList<int> &deletedIds, QObject *parent)
+    : QObject(parent), source_(source), changedIds_(changedIds), deletedIds_(deletedIds)
+{
+}
+
+void ContactUpdateLoader::start()
+{
+    ContactListUpdate update;
+    update.removedContactIds = deletedIds_;
+    foreach(int contactId, changedIds_) {
+        const ContactRecord contact = source_->contactDetails(contactId);
+        if(!contact.isValid()) {
+            update.removedContactIds.append(contactId);
+            continue;
+        }
+        update.entries.append(contact.listEntry());
+    }
+    emit updateLoaded(update);
+    emit finished();
+}
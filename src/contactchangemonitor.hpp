@@ -0,0 +1,99 @@
+#ifndef CONTACTCHANGEMONITOR_HPP
+#define CONTACTCHANGEMONITOR_HPP
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMetaType>
+
+#include <bb/pim/contacts/Contact>
+
+#include "contactlistentry.hpp"
+#include "contactsource.hpp"
+
+namespace bb { namespace pim { namespace contacts {
+class ContactService;
+}}}
+
+class QTimer;
+
+/**
+ * Changes to apply to the contact list, with the current list fields of
+ * added or changed contacts and the IDs of deleted ones.
+ */
+struct ContactListUpdate
+{
+    QList<ContactListEntry> entries;
+    QList<int> removedContactIds;
+};
+
+Q_DECLARE_METATYPE(ContactListUpdate)
+
+/**
+ * Watches the contact service for changes, and reports them in batches.
+ *
+ * Notifications arriving within a short interval of each other are
+ * merged, and only the affected contacts are then retrieved, away from the
+ * UI thread. A reset of the database, or a batch too large to be worth
+ * patching in, is reported as needing a full reload instead.
+ */
+class ContactChangeMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    ContactChangeMonitor(const ContactSourcePointer &source, QObject *parent=0);
+    virtual ~ContactChangeMonitor();
+
+    /**
+     * While paused, changes are only collected, and are reported once
+     * monitoring resumes.
+     */
+    void setPaused(bool paused);
+signals:
+    void contactsUpdated(const ContactListUpdate &update);
+    void reloadRequired();
+private slots:
+    void onContactsAdded(const QList<bb::pim::contacts::ContactId> &contactIds);
+    void onContactsChanged(const QList<bb::pim::contacts::ContactId> &contactIds);
+    void onContactsDeleted(const QList<bb::pim::contacts::ContactId> &contactIds);
+    void onContactsReset();
+    void onFlushChanges();
+    void onUpdateLoaded(const ContactListUpdate &update);
+    void onUpdateFinished();
+private:
+    void scheduleFlush();
+    ContactSourcePointer source_;
+    bb::pim::contacts::ContactService *contactService_;
+    QTimer *flushTimer_;
+    QElapsedTimer pendingTimer_;
+    QSet<int> changedIds_;
+    QSet<int> deletedIds_;
+    bool resetPending_;
+    bool paused_;
+    bool loading_;
+};
+
+/**
+ * Retrieves the list fields of a set of contacts on a worker thread.
+ * Contacts that no longer exist are reported as removed.
+ */
+class ContactUpdateLoader : public QObject
+{
+    Q_OBJECT
+public:
+    ContactUpdateLoader(const ContactSourcePointer &source, const QList<int> &changedIds,
+        const QList<int> &deletedIds, QObject *parent=0);
+    virtual ~ContactUpdateLoader() { }
+public slots:
+    void start();
+signals:
+    void updateLoaded(const ContactListUpdate &update);
+    void finished();
+private:
+    ContactSourcePointer source_;
+    QList<int> changedIds_;
+    QList<int> deletedIds_;
+};
+
+#endif // CONTACTCHANGEMONITOR_HPP
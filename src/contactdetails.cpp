@@ -0,0 +1,119 @@
+#include "contactdetails.hpp"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+
+#include "trace.hpp"
+
+ContactDetails ContactDetailsLoader::load(const ContactSourcePointer &source, int contactId)
+{
+    ContactDetails details;
+    {
+        TRACE_SCOPE("details", "fetch");
+        details.contact = source->contactDetails(contactId);
+    }
+    {
+        TRACE_SCOPE("details", "buildProperties");
+        details.properties = contactProperties(details.contact);
+    }
+    {
+        TRACE_SCOPE("details", "buildAttributes");
+        details.attributes = contactAttributes(details.contact);
+    }
+    return details;
+}
+
+QVariantList ContactDetailsLoader::contactProperties(const ContactRecord &contact)
+{
+    QVariantList properties;
+
+    foreach(const ContactRecordAccount &account, contact.sourceAccounts) {
+        QVariantMap map;
+        map["property"] = QCoreApplication::translate("ContactPage", "Source account");
+        map["title"] = account.displayName;
+        map["description"] = account.providerName;
+        map["status"] = account.id;
+        properties.append(map);
+    }
+
+    if(!contact.firstName.isEmpty()) {
+        QVariantMap map;
+        map["property"] = QCoreApplication::translate("ContactPage", "First name");
+        map["title"] = contact.firstName;
+        properties.append(map);
+    }
+
+    if(!contact.lastName.isEmpty()) {
+        QVariantMap map;
+        map["property"] = QCoreApplication::translate("ContactPage", "Last name");
+        map["title"] = contact.lastName;
+        properties.append(map);
+    }
+
+    foreach(const ContactRecordAttribute &attribute, contact.emails) {
+        QVariantMap map;
+        map["property"] = QCoreApplication::translate("ContactPage", "Email");
+        map["title"] = attribute.value;
+        map["status"] = attribute.label;
+        properties.append(map);
+    }
+
+    foreach(const ContactRecordAttribute &attribute, contact.phoneNumbers) {
+        QVariantMap map;
+        map["property"] = QCoreApplication::translate("ContactPage", "Phone");
+        map["title"] = attribute.value;
+        map["status"] = attribute.label;
+        properties.append(map);
+    }
+
+    foreach(const ContactRecordPhoto &photo, contact.photos) {
+        QVariantMap map;
+        map["property"] = QCoreApplication::translate("ContactPage", "Photo");
+        map["title"] = QCoreApplication::translate("ContactPage", "ID: %1").arg(photo.id);
+        map["description"] = QCoreApplication::translate("ContactPage", "Account: %1").arg(photo.sourceAccountId);
+        if(photo.id == contact.primaryPhotoId) {
+            map["status"] = QCoreApplication::translate("ContactPage", "Primary");
+        }
+        map["photoFilepath"] = photo.smallPhotoFilepath;
+        properties.append(map);
+    }
+
+    foreach(const ContactRecordAddress &address, contact.postalAddresses) {
+        QStringList fields;
+        if(!address.line1.isEmpty()) {
+            fields.append(address.line1);
+        }
+        if(!address.line2.isEmpty()) {
+            fields.append(address.line2);
+        }
+        if(!address.city.isEmpty()) {
+            fields.append(address.city);
+        }
+        if(!address.region.isEmpty()) {
+            fields.append(address.region);
+        }
+        if(!address.country.isEmpty()) {
+            fields.append(address.country);
+        }
+        QVariantMap map;
+        map["property"] = QCoreApplication::translate("ContactPage", "Address");
+        map["title"] = fields.join("; ");
+        map["description"] = address.label;
+        properties.append(map);
+    }
+    return properties;
+}
+
+QVariantList ContactDetailsLoader::contactAttributes(const ContactRecord &contact)
+{
+    QVariantList attributes;
+    foreach(const ContactRecordAttribute &attribute, contact.attributes) {
+        QVariantMap map;
+        map["kind"] = attribute.kindName;
+        map["title"] = attribute.subKindName;
+        map["description"] = attribute.value;
+        map["status"] = attribute.id;
+        attributes.append(map);
+    }
+    return attributes;
+}
@@ -0,0 +1,35 @@
+#ifndef CONTACTDETAILS_HPP
+#define CONTACTDETAILS_HPP
+
+#include <QtCore/QVariant>
+#include <QtCore/QMetaType>
+
+#include "contactrecord.hpp"
+#include "contactsource.hpp"
+
+struct ContactDetails
+{
+    ContactRecord contact;
+    QVariantList properties;
+    QVariantList attributes;
+};
+
+Q_DECLARE_METATYPE(ContactDetails)
+
+/**
+ * Retrieves the details of a single contact and builds the list rows for
+ * it. Called by DetailsCache on its worker threads, and by the tools.
+ */
+class ContactDetailsLoader
+{
+public:
+    /**
+     * Retrieves and builds the details of a contact on the calling thread.
+     */
+    static ContactDetails load(const ContactSourcePointer &source, int contactId);
+
+    static QVariantList contactProperties(const ContactRecord &contact);
+    static QVariantList contactAttributes(const ContactRecord &contact);
+};
+
+#endif // CONTACTDETAILS_HPP
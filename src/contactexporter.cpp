@@ -0,0 +1,131 @@
+#include "contactexporter.hpp"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QDebug>
+
+#include "jsonwriter.hpp"
+
+void ContactExporter::writeContact(JsonWriter &writer, const ContactRecord &contact)
+{
+    // Members are written in sorted order, matching earlier exports
+    writer.beginObject();
+
+    writer.writeName("attributes");
+    writer.beginArray();
+    foreach(const ContactRecordAttribute &attribute, contact.attributes) {
+        writer.beginObject();
+        writer.writeName("id");
+        writer.writeNumber(attribute.id);
+        writer.writeName("kind");
+        writer.writeString(attribute.kindName);
+        writer.writeName("sources");
+        writer.beginArray();
+        foreach(int source, attribute.sources) {
+            writer.writeNumber(source);
+        }
+        writer.endArray();
+        writer.writeName("subKind");
+        writer.writeString(attribute.subKindName);
+        writer.writeName("value");
+        writer.writeString(attribute.value);
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.writeName("header");
+    writer.beginObject();
+    writer.writeName("accountId");
+    writer.writeNumber(contact.accountId);
+    writer.writeName("contactId");
+    writer.writeNumber(contact.id);
+    writer.writeName("displayCompanyName");
+    writer.writeString(contact.displayCompanyName);
+    writer.writeName("displayName");
+    writer.writeString(contact.displayName);
+    writer.endObject();
+
+    writer.writeName("photos");
+    writer.beginArray();
+    foreach(const ContactRecordPhoto &photo, contact.photos) {
+        writer.beginObject();
+        writer.writeName("id");
+        writer.writeNumber(photo.id);
+        writer.writeName("isPrimary");
+        writer.writeBool(photo.id == contact.primaryPhotoId);
+        writer.writeName("sourceAccountId");
+        writer.writeNumber(photo.sourceAccountId);
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.writeName("sourceAccounts");
+    writer.beginArray();
+    foreach(const ContactRecordAccount &account, contact.sourceAccounts) {
+        writer.beginObject();
+        writer.writeName("displayName");
+        writer.writeString(account.displayName);
+        writer.writeName("id");
+        writer.writeNumber(account.id);
+        writer.writeName("providerId");
+        writer.writeString(account.providerId);
+        writer.writeName("providerName");
+        writer.writeString(account.providerName);
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.endObject();
+}
+
+BulkExportHandler::BulkExportHandler(const QString &fileName) : file_(fileName)
+{
+}
+
+BulkExportHandler::~BulkExportHandler()
+{
+}
+
+QByteArray BulkExportHandler::processPage(const QList<ContactRecord> &contacts)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    JsonWriter writer(&buffer);
+    foreach(const ContactRecord &contact, contacts) {
+        ContactExporter::writeContact(writer, contact);
+        writer.endLine();
+    }
+    writer.flush();
+    return data;
+}
+
+bool BulkExportHandler::consumePage(const QByteArray &result)
+{
+    if(!file_.isOpen() && !file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Unable to open file for writing:" << file_.errorString();
+        return false;
+    }
+    if(file_.write(result) != result.size()) {
+        qWarning() << "Unable to write export data:" << file_.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool BulkExportHandler::finish(bool success)
+{
+    if(!success) {
+        file_.remove();
+        return false;
+    }
+    if(!file_.isOpen() && !file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Unable to open file for writing:" << file_.errorString();
+        return false;
+    }
+    file_.close();
+    file_.setPermissions(
+        QFile::ReadOwner | QFile::WriteOwner |
+        QFile::ReadGroup | QFile::WriteGroup |
+        QFile::ReadOther | QFile::WriteOther);
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef CONTACTEXPORTER_HPP
+#define CONTACTEXPORTER_HPP
+
+#include <QtCore/QFile>
+
+#include "contactrecord.hpp"
+#include "contactscanner.hpp"
+
+class JsonWriter;
+
+/**
+ * Writes contacts in the export format used by "Save Data", with the
+ * header, sourceAccounts, photos and attributes of each contact.
+ */
+class ContactExporter
+{
+public:
+    static void writeContact(JsonWriter &writer, const ContactRecord &contact);
+};
+
+/**
+ * Scan handler that exports every contact to a JSON Lines file, with one
+ * contact per line. Pages are serialized on the scanner's worker threads
+ * and appended to the file in order.
+ */
+class BulkExportHandler : public ContactScanHandler
+{
+public:
+    BulkExportHandler(const QString &fileName);
+    virtual ~BulkExportHandler();
+    virtual QByteArray processPage(const QList<ContactRecord> &contacts);
+    virtual bool consumePage(const QByteArray &result);
+    virtual bool finish(bool success);
+private:
+    QFile file_;
+};
+
+#endif // CONTACTEXPORTER_HPP
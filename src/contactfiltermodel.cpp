@@ -0,0 +1,111 @@
+#include "contactfiltermodel.hpp"
+#include "contactlistmodel.hpp"
+
+#include <QtCore/QtAlgorithms>
+
+using namespace bb::cascades;
+
+ContactFilterModel::ContactFilterModel(ContactListModel *sourceModel, QObject *parent)
+    : DataModel(parent), sourceModel_(sourceModel)
+{
+    connect(sourceModel_, SIGNAL(rowUpdated(int)), this, SLOT(onSourceRowUpdated(int)));
+}
+
+ContactFilterModel::~ContactFilterModel()
+{
+}
+
+int ContactFilterModel::childCount(const QVariantList &indexPath)
+{
+    if(indexPath.isEmpty()) {
+        return sections_.size();
+    }
+    else if(indexPath.size() == 1) {
+        const int section = indexPath[0].toInt();
+        if(section >= 0 && section < sections_.size()) {
+            return sections_[section].count;
+        }
+    }
+    return 0;
+}
+
+bool ContactFilterModel::hasChildren(const QVariantList &indexPath)
+{
+    return childCount(indexPath) > 0;
+}
+
+QString ContactFilterModel::itemType(const QVariantList &indexPath)
+{
+    if(indexPath.size() == 1) {
+        return QLatin1String("header");
+    }
+    else if(indexPath.size() == 2) {
+        return QLatin1String("item");
+    }
+    return QString();
+}
+
+QVariant ContactFilterModel::data(const QVariantList &indexPath)
+{
+    if(indexPath.size() == 1) {
+        const int section = indexPath[0].toInt();
+        if(section >= 0 && section < sections_.size()) {
+            return sections_[section].title;
+        }
+    }
+    else if(indexPath.size() == 2) {
+        const int row = sourceRow(indexPath);
+        if(row >= 0) {
+            return sourceModel_->rowData(row);
+        }
+    }
+    return QVariant();
+}
+
+void ContactFilterModel::setSourceRows(const QVector<int> &sourceRows)
+{
+    sourceRows_ = sourceRows;
+    sections_.clear();
+
+    QChar key;
+    for(int i = 0; i < sourceRows_.size(); i++) {
+        const QString name = sourceModel_->displayName(sourceRows_[i]);
+        const QChar rowKey = ContactListModel::sectionKey(name);
+        if(sections_.isEmpty() || rowKey != key) {
+            Section section;
+            section.title = ContactListModel::sectionTitle(name);
+            section.first = i;
+            section.count = 0;
+            sections_.append(section);
+            key = rowKey;
+        }
+        sections_.last().count++;
+    }
+
+    emit itemsChanged(DataModelChangeType::Init);
+}
+
+void ContactFilterModel::onSourceRowUpdated(int row)
+{
+    QVector<int>::const_iterator it = qBinaryFind(sourceRows_.constBegin(), sourceRows_.constEnd(), row);
+    if(it == sourceRows_.constEnd()) { return; }
+
+    const int index = it - sourceRows_.constBegin();
+    for(int section = 0; section < sections_.size(); section++) {
+        if(index < sections_[section].first + sections_[section].count) {
+            emit itemUpdated(QVariantList() << section << (index - sections_[section].first));
+            break;
+        }
+    }
+}
+
+int ContactFilterModel::sourceRow(const QVariantList &indexPath) const
+{
+    const int section = indexPath[0].toInt();
+    const int index = indexPath[1].toInt();
+    if(section < 0 || section >= sections_.size()
+        || index < 0 || index >= sections_[section].count) {
+        return -1;
+    }
+    return sourceRows_[sections_[section].first + index];
+}
@@ -0,0 +1,53 @@
+#ifndef CONTACTFILTERMODEL_HPP
+#define CONTACTFILTERMODEL_HPP
+
+#include <QtCore/QVector>
+
+#include <bb/cascades/DataModel>
+
+class ContactListModel;
+
+/**
+ * Filtered projection of a ContactListModel, presenting a sorted subset
+ * of its rows with the same first character grouping.
+ */
+class ContactFilterModel : public bb::cascades::DataModel
+{
+    Q_OBJECT
+public:
+    ContactFilterModel(ContactListModel *sourceModel, QObject *parent=0);
+    virtual ~ContactFilterModel();
+
+    virtual int childCount(const QVariantList &indexPath);
+    virtual bool hasChildren(const QVariantList &indexPath);
+    virtual QString itemType(const QVariantList &indexPath);
+    virtual QVariant data(const QVariantList &indexPath);
+
+    ContactListModel *sourceModel() const { return sourceModel_; }
+
+    /**
+     * Rows of the source model included in the projection, in ascending
+     * order.
+     */
+    const QVector<int> &sourceRows() const { return sourceRows_; }
+    void setSourceRows(const QVector<int> &sourceRows);
+
+private slots:
+    void onSourceRowUpdated(int row);
+
+private:
+    struct Section
+    {
+        QString title;
+        int first;
+        int count;
+    };
+
+    int sourceRow(const QVariantList &indexPath) const;
+
+    ContactListModel *sourceModel_;
+    QVector<int> sourceRows_;
+    QVector<Section> sections_;
+};
+
+#endif // CONTACTFILTERMODEL_HPP
@@ -0,0 +1,52 @@
+#ifndef CONTACTLISTENTRY_HPP
+#define CONTACTLISTENTRY_HPP
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QMetaType>
+
+/**
+ * The fields of a contact shown in the contact list.
+ */
+struct ContactListEntry
+{
+    ContactListEntry() : contactId(0) { }
+    int contactId;
+    QString displayName;
+    QString displayCompanyName;
+    QString photoFilepath;
+};
+
+/**
+ * Compares contacts in the order the list shows them: by display name,
+ * ignoring case, and then by contact ID. Names not starting with a letter
+ * all share the "#" section, so they are kept together ahead of the
+ * letters, even those like '{' and '~' that would otherwise sort after 'z'.
+ */
+inline int compareNames(const QString &name1, int contactId1, const QString &name2, int contactId2)
+{
+    const bool other1 = name1.isEmpty() || !name1[0].isLetter();
+    const bool other2 = name2.isEmpty() || !name2[0].isLetter();
+    if(other1 != other2) { return other1 ? -1 : 1; }
+
+    const int result = QString::compare(name1, name2, Qt::CaseInsensitive);
+    if(result != 0) { return result; }
+    return contactId1 - contactId2;
+}
+
+inline bool entryLessThan(const ContactListEntry &entry1, const ContactListEntry &entry2)
+{
+    return compareNames(entry1.displayName, entry1.contactId, entry2.displayName, entry2.contactId) < 0;
+}
+
+/**
+ * A page of list entries handed from a loader thread to the UI thread.
+ * The entries are shared rather than copied as the page changes threads,
+ * and must not be modified once the page has been sent.
+ */
+typedef QSharedPointer<const QVector<ContactListEntry> > ContactListPage;
+
+Q_DECLARE_METATYPE(ContactListPage)
+
+#endif // CONTACTLISTENTRY_HPP
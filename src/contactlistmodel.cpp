@@ -0,0 +1,452 @@
+#include "contactlistmodel.hpp"
+
+#include <QtCore/QVariantMap>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QStringList>
+
+#include "photocache.hpp"
+
+using namespace bb::cascades;
+
+namespace
+{
+// Rows on either side of the one being shown whose photos are decoded
+const int PrefetchDistance = 24;
+
+class EntryLessThan
+{
+public:
+    EntryLessThan(const QList<ContactListEntry> &entries) : entries_(entries) { }
+    bool operator()(int index1, int index2) const
+    {
+        return entryLessThan(entries_[index1], entries_[index2]);
+    }
+private:
+    const QList<ContactListEntry> &entries_;
+};
+}
+
+ContactListModel::ContactListModel(QObject *parent) : DataModel(parent),
+    prefetchRow_(-1)
+{
+    PhotoCache *photoCache = PhotoCache::instance();
+    if(photoCache) {
+        connect(photoCache, SIGNAL(imageReady(QString)), this, SLOT(onImageReady(QString)));
+    }
+}
+
+ContactListModel::~ContactListModel()
+{
+}
+
+int ContactListModel::childCount(const QVariantList &indexPath)
+{
+    if(indexPath.isEmpty()) {
+        return sections_.size();
+    }
+    else if(indexPath.size() == 1) {
+        const int section = indexPath[0].toInt();
+        if(section >= 0 && section < sections_.size()) {
+            return sections_[section].count;
+        }
+    }
+    return 0;
+}
+
+bool ContactListModel::hasChildren(const QVariantList &indexPath)
+{
+    return childCount(indexPath) > 0;
+}
+
+QString ContactListModel::itemType(const QVariantList &indexPath)
+{
+    if(indexPath.size() == 1) {
+        return QLatin1String("header");
+    }
+    else if(indexPath.size() == 2) {
+        return QLatin1String("item");
+    }
+    return QString();
+}
+
+QVariant ContactListModel::data(const QVariantList &indexPath)
+{
+    if(indexPath.size() == 1) {
+        const int section = indexPath[0].toInt();
+        if(section >= 0 && section < sections_.size()) {
+            return sections_[section].title;
+        }
+    }
+    else if(indexPath.size() == 2) {
+        const int index = row(indexPath);
+        if(index >= 0) {
+            prefetchPhotos(index);
+            return rowData(index);
+        }
+    }
+    return QVariant();
+}
+
+QVariant ContactListModel::rowData(int row) const
+{
+    QVariantMap map;
+    map["displayName"] = displayName(row);
+    map["displayCompanyName"] = displayCompanyName(row);
+    map["contactId"] = contactIds_[row];
+
+    const QString &filePath = photoFilepaths_[row];
+    PhotoCache *photoCache = PhotoCache::instance();
+    if(!filePath.isEmpty() && photoCache) {
+        const bb::cascades::Image image = photoCache->image(filePath);
+        if(!image.isNull()) {
+            map["image"] = QVariant::fromValue(image);
+        }
+        else {
+            // The row is refreshed once the photo has been decoded
+            photoRequests_.insert(filePath, contactIds_[row]);
+        }
+    }
+    return map;
+}
+
+ContactListEntry ContactListModel::entry(int row) const
+{
+    ContactListEntry entry;
+    entry.contactId = contactIds_[row];
+    entry.displayName = strings_[nameIds_[row]];
+    entry.displayCompanyName = strings_[companyIds_[row]];
+    entry.photoFilepath = photoFilepaths_[row];
+    return entry;
+}
+
+QVariantList ContactListModel::indexPath(int row) const
+{
+    QVariantList indexPath;
+    const int section = sectionIndex(row);
+    if(section >= 0) {
+        indexPath << section << (row - sections_[section].first);
+    }
+    return indexPath;
+}
+
+int ContactListModel::row(const QVariantList &indexPath) const
+{
+    if(indexPath.size() != 2) { return -1; }
+    const int section = indexPath[0].toInt();
+    const int index = indexPath[1].toInt();
+    if(section < 0 || section >= sections_.size()
+        || index < 0 || index >= sections_[section].count) {
+        return -1;
+    }
+    return sections_[section].first + index;
+}
+
+int ContactListModel::rowForContact(int contactId) const
+{
+    // Rebuilt on demand after the rows have moved
+    if(contactRows_.isEmpty() && !contactIds_.isEmpty()) {
+        contactRows_.reserve(contactIds_.size());
+        for(int i = 0; i < contactIds_.size(); i++) {
+            contactRows_.insert(contactIds_[i], i);
+        }
+    }
+    return contactRows_.value(contactId, -1);
+}
+
+void ContactListModel::insertList(const QList<ContactListEntry> &entries)
+{
+    if(entries.isEmpty()) { return; }
+    mergeEntries(entries);
+    emit itemsChanged(DataModelChangeType::AddRemove);
+    emit contentsChanged();
+}
+
+void ContactListModel::removeList(const QList<int> &contactIds)
+{
+    if(removeRows(contactIds.toSet()) < 0) { return; }
+    emit itemsChanged(DataModelChangeType::AddRemove);
+    emit contentsChanged();
+}
+
+void ContactListModel::updateList(const QList<ContactListEntry> &entries, const QList<int> &removedContactIds)
+{
+    QSet<int> contactIds = removedContactIds.toSet();
+    foreach(const ContactListEntry &entry, entries) {
+        contactIds.insert(entry.contactId);
+    }
+
+    const bool removed = removeRows(contactIds) >= 0;
+    if(!entries.isEmpty()) {
+        mergeEntries(entries);
+    }
+    else if(!removed) {
+        return;
+    }
+    emit itemsChanged(DataModelChangeType::AddRemove);
+    emit contentsChanged();
+}
+
+void ContactListModel::mergeEntries(const QList<ContactListEntry> &entries)
+{
+    contactRows_.clear();
+
+    // Order the batch, which is usually already sorted
+    QVector<int> order(entries.size());
+    bool sorted = true;
+    for(int i = 0; i < entries.size(); i++) {
+        order[i] = i;
+        if(sorted && i > 0
+            && compareNames(entries[i - 1].displayName, entries[i - 1].contactId,
+                entries[i].displayName, entries[i].contactId) > 0) {
+            sorted = false;
+        }
+    }
+    if(!sorted) {
+        qStableSort(order.begin(), order.end(), EntryLessThan(entries));
+    }
+
+    const int oldSize = contactIds_.size();
+    const int newSize = oldSize + entries.size();
+    const ContactListEntry &firstEntry = entries[order.first()];
+
+    if(oldSize == 0 || compareNames(strings_[nameIds_[oldSize - 1]], contactIds_[oldSize - 1],
+        firstEntry.displayName, firstEntry.contactId) <= 0) {
+        // The whole batch sorts after the existing rows, so just append it
+        contactIds_.reserve(newSize);
+        nameIds_.reserve(newSize);
+        companyIds_.reserve(newSize);
+        photoFilepaths_.reserve(newSize);
+        foreach(int index, order) {
+            const ContactListEntry &entry = entries[index];
+            contactIds_.append(entry.contactId);
+            nameIds_.append(intern(entry.displayName));
+            companyIds_.append(intern(entry.displayCompanyName));
+            photoFilepaths_.append(entry.photoFilepath);
+        }
+        rebuildSections(oldSize);
+    }
+    else {
+        QVector<int> contactIds;
+        QVector<int> nameIds;
+        QVector<int> companyIds;
+        QVector<QString> photoFilepaths;
+        contactIds.reserve(newSize);
+        nameIds.reserve(newSize);
+        companyIds.reserve(newSize);
+        photoFilepaths.reserve(newSize);
+
+        // Rows before the first new entry are unaffected by the merge
+        const int start = lowerBound(firstEntry.displayName, firstEntry.contactId);
+        int i = start;
+        int j = 0;
+        while(i < oldSize || j < order.size()) {
+            const ContactListEntry *entry = (j < order.size()) ? &entries[order[j]] : 0;
+            if(i < oldSize && (!entry || compareNames(strings_[nameIds_[i]], contactIds_[i],
+                entry->displayName, entry->contactId) <= 0)) {
+                contactIds.append(contactIds_[i]);
+                nameIds.append(nameIds_[i]);
+                companyIds.append(companyIds_[i]);
+                photoFilepaths.append(photoFilepaths_[i]);
+                i++;
+            }
+            else {
+                contactIds.append(entry->contactId);
+                nameIds.append(intern(entry->displayName));
+                companyIds.append(intern(entry->displayCompanyName));
+                photoFilepaths.append(entry->photoFilepath);
+                j++;
+            }
+        }
+
+        contactIds_.resize(start);
+        nameIds_.resize(start);
+        companyIds_.resize(start);
+        photoFilepaths_.resize(start);
+        contactIds_ += contactIds;
+        nameIds_ += nameIds;
+        companyIds_ += companyIds;
+        photoFilepaths_ += photoFilepaths;
+        rebuildSections(start);
+    }
+}
+
+int ContactListModel::removeRows(const QSet<int> &contactIds)
+{
+    if(contactIds.isEmpty()) { return -1; }
+
+    // Compact the columns in place, keeping the remaining rows in order.
+    // Strings interned for removed rows stay in the table until the
+    // model is cleared.
+    const int size = contactIds_.size();
+    int first = -1;
+    int j = 0;
+    for(int i = 0; i < size; i++) {
+        if(contactIds.contains(contactIds_[i])) {
+            if(first < 0) {
+                first = i;
+            }
+            continue;
+        }
+        if(i != j) {
+            contactIds_[j] = contactIds_[i];
+            nameIds_[j] = nameIds_[i];
+            companyIds_[j] = companyIds_[i];
+            photoFilepaths_[j] = photoFilepaths_[i];
+        }
+        j++;
+    }
+    if(first < 0) { return -1; }
+
+    contactIds_.resize(j);
+    nameIds_.resize(j);
+    companyIds_.resize(j);
+    photoFilepaths_.resize(j);
+    contactRows_.clear();
+    rebuildSections(first);
+    return first;
+}
+
+void ContactListModel::clear()
+{
+    contactIds_.clear();
+    nameIds_.clear();
+    companyIds_.clear();
+    photoFilepaths_.clear();
+    strings_.clear();
+    stringIds_.clear();
+    sections_.clear();
+    contactRows_.clear();
+    photoRequests_.clear();
+    prefetchRow_ = -1;
+    emit itemsChanged(DataModelChangeType::Init);
+    emit contentsChanged();
+}
+
+void ContactListModel::onImageReady(const QString &filePath)
+{
+    QHash<QString, int>::iterator it = photoRequests_.find(filePath);
+    if(it == photoRequests_.end()) { return; }
+    const int row = rowForContact(it.value());
+    photoRequests_.erase(it);
+
+    if(row >= 0 && photoFilepaths_[row] == filePath) {
+        emit itemUpdated(indexPath(row));
+        emit rowUpdated(row);
+    }
+}
+
+void ContactListModel::prefetchPhotos(int row)
+{
+    // Only prefetch again once the list has moved a fair distance
+    if(prefetchRow_ >= 0 && qAbs(row - prefetchRow_) < PrefetchDistance / 2) { return; }
+    PhotoCache *photoCache = PhotoCache::instance();
+    if(!photoCache) { return; }
+    prefetchRow_ = row;
+
+    // Requests are served most recent first, so the nearest rows go last
+    QStringList filePaths;
+    for(int distance = PrefetchDistance; distance > 0; distance--) {
+        if(row + distance < photoFilepaths_.size()) {
+            filePaths.append(photoFilepaths_[row + distance]);
+        }
+        if(row - distance >= 0) {
+            filePaths.append(photoFilepaths_[row - distance]);
+        }
+    }
+    photoCache->prefetch(filePaths);
+}
+
+int ContactListModel::intern(const QString &str)
+{
+    QHash<QString, int>::const_iterator it = stringIds_.constFind(str);
+    if(it != stringIds_.constEnd()) {
+        return it.value();
+    }
+    const int id = strings_.size();
+    strings_.append(str);
+    stringIds_.insert(str, id);
+    return id;
+}
+
+int ContactListModel::lowerBound(const QString &displayName, int contactId) const
+{
+    int first = 0;
+    int count = contactIds_.size();
+    while(count > 0) {
+        const int step = count / 2;
+        const int middle = first + step;
+        if(compareNames(strings_[nameIds_[middle]], contactIds_[middle], displayName, contactId) < 0) {
+            first = middle + 1;
+            count -= step + 1;
+        }
+        else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+int ContactListModel::sectionIndex(int row) const
+{
+    int low = 0;
+    int high = sections_.size() - 1;
+    while(low <= high) {
+        const int middle = (low + high) / 2;
+        const Section &section = sections_[middle];
+        if(row < section.first) {
+            high = middle - 1;
+        }
+        else if(row >= section.first + section.count) {
+            low = middle + 1;
+        }
+        else {
+            return middle;
+        }
+    }
+    return -1;
+}
+
+void ContactListModel::rebuildSections(int fromRow)
+{
+    // Sections ending before the one that holds the row preceding fromRow
+    // are unaffected, everything from there on is rebuilt.
+    int row = 0;
+    const int section = (fromRow > 0) ? sectionIndex(fromRow - 1) : -1;
+    if(section >= 0) {
+        row = sections_[section].first;
+        sections_.resize(section);
+    }
+    else {
+        sections_.clear();
+    }
+
+    const int size = contactIds_.size();
+    QChar key;
+    while(row < size) {
+        const QString &name = strings_[nameIds_[row]];
+        const QChar rowKey = sectionKey(name);
+        if(sections_.isEmpty() || rowKey != key) {
+            Section newSection;
+            newSection.title = sectionTitle(name);
+            newSection.first = row;
+            newSection.count = 0;
+            sections_.append(newSection);
+            key = rowKey;
+        }
+        sections_.last().count++;
+        row++;
+    }
+}
+
+QChar ContactListModel::sectionKey(const QString &displayName)
+{
+    if(displayName.isEmpty() || !displayName[0].isLetter()) {
+        return QLatin1Char('#');
+    }
+    return displayName[0].toUpper();
+}
+
+QString ContactListModel::sectionTitle(const QString &displayName)
+{
+    return QString(sectionKey(displayName));
+}
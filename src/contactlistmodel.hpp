@@ -0,0 +1,112 @@
+#ifndef CONTACTLISTMODEL_HPP
+#define CONTACTLISTMODEL_HPP
+
+#include <QtCore/QVector>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+#include <bb/cascades/DataModel>
+
+#include "contactlistentry.hpp"
+
+/**
+ * Data model for the main contact list, grouped by the first character of
+ * the display name.
+ *
+ * Rows are stored column-wise, with names and company names interned in a
+ * shared string table, and the QVariantMap for a row is only built when the
+ * list asks for it. Photos come from the PhotoCache, which is asked to
+ * decode the photos of the rows around those the list is showing.
+ */
+class ContactListModel : public bb::cascades::DataModel
+{
+    Q_OBJECT
+public:
+    ContactListModel(QObject *parent=0);
+    virtual ~ContactListModel();
+
+    virtual int childCount(const QVariantList &indexPath);
+    virtual bool hasChildren(const QVariantList &indexPath);
+    virtual QString itemType(const QVariantList &indexPath);
+    virtual QVariant data(const QVariantList &indexPath);
+
+    int size() const { return contactIds_.size(); }
+    int contactId(int row) const { return contactIds_[row]; }
+    QString displayName(int row) const { return strings_[nameIds_[row]]; }
+    QString displayCompanyName(int row) const { return strings_[companyIds_[row]]; }
+    QString photoFilepath(int row) const { return photoFilepaths_[row]; }
+    ContactListEntry entry(int row) const;
+    QVariant rowData(int row) const;
+
+    QVariantList indexPath(int row) const;
+    int row(const QVariantList &indexPath) const;
+    int rowForContact(int contactId) const;
+
+    /**
+     * Merges a batch of entries into the model in a single pass, emitting
+     * one change notification for the whole batch. Batches that are
+     * already sorted by display name, as delivered by the contact service,
+     * skip the sorting step.
+     */
+    void insertList(const QList<ContactListEntry> &entries);
+
+    void removeList(const QList<int> &contactIds);
+
+    /**
+     * Replaces the rows of the given entries, which may move as a result,
+     * and removes the rows of the given contact IDs, emitting one change
+     * notification for both.
+     */
+    void updateList(const QList<ContactListEntry> &entries, const QList<int> &removedContactIds);
+
+    void clear();
+
+    static QChar sectionKey(const QString &displayName);
+    static QString sectionTitle(const QString &displayName);
+
+signals:
+    /**
+     * Emitted whenever rows are added, removed or reordered.
+     */
+    void contentsChanged();
+
+    /**
+     * Emitted when the contents of a row change without it moving, such
+     * as when its photo becomes available.
+     */
+    void rowUpdated(int row);
+
+private slots:
+    void onImageReady(const QString &filePath);
+
+private:
+    struct Section
+    {
+        QString title;
+        int first;
+        int count;
+    };
+
+    int intern(const QString &str);
+    void mergeEntries(const QList<ContactListEntry> &entries);
+    int removeRows(const QSet<int> &contactIds);
+    int lowerBound(const QString &displayName, int contactId) const;
+    int sectionIndex(int row) const;
+    void rebuildSections(int fromRow);
+    void prefetchPhotos(int row);
+
+    QVector<int> contactIds_;
+    QVector<int> nameIds_;
+    QVector<int> companyIds_;
+    QVector<QString> photoFilepaths_;
+    QVector<QString> strings_;
+    QHash<QString, int> stringIds_;
+    QVector<Section> sections_;
+    mutable QHash<int, int> contactRows_;
+    mutable QHash<QString, int> photoRequests_;
+    int prefetchRow_;
+};
+
+#endif // CONTACTLISTMODEL_HPP
@@ -0,0 +1,221 @@
+#include "contactlistsnapshot.hpp"
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QDebug>
+
+#include <stdio.h>
+
+namespace
+{
+// Written in native byte order, so a swapped magic number is rejected
+const quint32 SnapshotMagic = 0x4E534943; // "CISN"
+const quint32 SnapshotVersion = 1;
+
+struct SnapshotHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 rowCount;
+    quint32 stringCount;
+    quint32 charCount;
+    quint32 reserved;
+};
+
+struct SnapshotRow
+{
+    qint32 contactId;
+    quint32 nameId;
+    quint32 companyId;
+    quint32 photoId;
+};
+
+struct SnapshotString
+{
+    quint32 offset;
+    quint32 length;
+};
+
+qint64 snapshotSize(const SnapshotHeader &header)
+{
+    return qint64(sizeof(SnapshotHeader))
+        + qint64(header.rowCount) * qint64(sizeof(SnapshotRow))
+        + qint64(header.stringCount) * qint64(sizeof(SnapshotString))
+        + qint64(header.charCount) * qint64(sizeof(ushort));
+}
+
+// Serializes writers sharing the temporary file name
+QMutex writeMutex;
+}
+
+ContactListSnapshot::ContactListSnapshot() : data_(0), size_(0)
+{
+}
+
+ContactListSnapshot::~ContactListSnapshot()
+{
+    close();
+}
+
+bool ContactListSnapshot::open(const QString &fileName)
+{
+    close();
+
+    file_.setFileName(fileName);
+    if(!file_.open(QIODevice::ReadOnly)) { return false; }
+
+    const qint64 size = file_.size();
+    if(size < qint64(sizeof(SnapshotHeader))) {
+        file_.close();
+        return false;
+    }
+
+    uchar *data = file_.map(0, size);
+    if(!data) {
+        file_.close();
+        return false;
+    }
+
+    const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader *>(data);
+    if(header->magic != SnapshotMagic || header->version != SnapshotVersion
+        || snapshotSize(*header) != size) {
+        qWarning() << "Ignoring invalid contact list snapshot" << fileName;
+        file_.unmap(data);
+        file_.close();
+        return false;
+    }
+
+    data_ = data;
+    size_ = size;
+    return true;
+}
+
+void ContactListSnapshot::close()
+{
+    if(data_) {
+        file_.unmap(const_cast<uchar *>(data_));
+        data_ = 0;
+        size_ = 0;
+    }
+    if(file_.isOpen()) {
+        file_.close();
+    }
+}
+
+QList<ContactListEntry> ContactListSnapshot::entries() const
+{
+    QList<ContactListEntry> entries;
+    if(!data_) { return entries; }
+
+    const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader *>(data_);
+    const SnapshotRow *rows = reinterpret_cast<const SnapshotRow *>(header + 1);
+    const SnapshotString *strings = reinterpret_cast<const SnapshotString *>(rows + header->rowCount);
+    const QChar *chars = reinterpret_cast<const QChar *>(strings + header->stringCount);
+
+    // Every distinct string is wrapped once, and shared by the rows using it
+    QVector<QString> table(header->stringCount);
+    for(quint32 i = 0; i < header->stringCount; i++) {
+        const SnapshotString &str = strings[i];
+        if(quint64(str.offset) + str.length > header->charCount) {
+            qWarning() << "Contact list snapshot has an invalid string table";
+            return QList<ContactListEntry>();
+        }
+        table[i] = QString::fromRawData(chars + str.offset, str.length);
+    }
+
+    entries.reserve(header->rowCount);
+    for(quint32 i = 0; i < header->rowCount; i++) {
+        const SnapshotRow &row = rows[i];
+        if(row.nameId >= header->stringCount || row.companyId >= header->stringCount
+            || row.photoId >= header->stringCount) {
+            qWarning() << "Contact list snapshot has an invalid row";
+            return QList<ContactListEntry>();
+        }
+        ContactListEntry entry;
+        entry.contactId = row.contactId;
+        entry.displayName = table[row.nameId];
+        entry.displayCompanyName = table[row.companyId];
+        entry.photoFilepath = table[row.photoId];
+        entries.append(entry);
+    }
+    return entries;
+}
+
+bool ContactListSnapshot::write(const QString &fileName, const QList<ContactListEntry> &entries)
+{
+    QVector<SnapshotRow> rows;
+    QVector<SnapshotString> strings;
+    QVector<QString> table;
+    QHash<QString, quint32> stringIds;
+    quint32 charCount = 0;
+
+    rows.reserve(entries.size());
+    foreach(const ContactListEntry &entry, entries) {
+        const QString *fields[3] = { &entry.displayName, &entry.displayCompanyName, &entry.photoFilepath };
+        quint32 ids[3];
+        for(int i = 0; i < 3; i++) {
+            QHash<QString, quint32>::const_iterator it = stringIds.constFind(*fields[i]);
+            if(it != stringIds.constEnd()) {
+                ids[i] = it.value();
+                continue;
+            }
+            SnapshotString str;
+            str.offset = charCount;
+            str.length = fields[i]->length();
+            charCount += str.length;
+            ids[i] = strings.size();
+            strings.append(str);
+            table.append(*fields[i]);
+            stringIds.insert(*fields[i], ids[i]);
+        }
+
+        SnapshotRow row;
+        row.contactId = entry.contactId;
+        row.nameId = ids[0];
+        row.companyId = ids[1];
+        row.photoId = ids[2];
+        rows.append(row);
+    }
+
+    SnapshotHeader header;
+    header.magic = SnapshotMagic;
+    header.version = SnapshotVersion;
+    header.rowCount = rows.size();
+    header.stringCount = strings.size();
+    header.charCount = charCount;
+    header.reserved = 0;
+
+    QMutexLocker locker(&writeMutex);
+    const QString tempFileName = fileName + QLatin1String(".tmp");
+    QFile file(tempFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Unable to write contact list snapshot:" << file.errorString();
+        return false;
+    }
+
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header))
+        && file.write(reinterpret_cast<const char *>(rows.constData()), rows.size() * sizeof(SnapshotRow))
+            == qint64(rows.size() * sizeof(SnapshotRow))
+        && file.write(reinterpret_cast<const char *>(strings.constData()), strings.size() * sizeof(SnapshotString))
+            == qint64(strings.size() * sizeof(SnapshotString));
+    for(int i = 0; ok && i < table.size(); i++) {
+        const qint64 length = table[i].length() * sizeof(ushort);
+        ok = file.write(reinterpret_cast<const char *>(table[i].constData()), length) == length;
+    }
+    file.close();
+
+    // Renaming over the old snapshot leaves any existing mapping intact
+    if(!ok || ::rename(QFile::encodeName(tempFileName).constData(), QFile::encodeName(fileName).constData()) != 0) {
+        qWarning() << "Unable to write contact list snapshot";
+        QFile::remove(tempFileName);
+        return false;
+    }
+    return true;
+}
+
+void ContactListSnapshotWriter::run()
+{
+    ContactListSnapshot::write(fileName_, entries_);
+}
@@ -0,0 +1,64 @@
+#ifndef CONTACTLISTSNAPSHOT_HPP
+#define CONTACTLISTSNAPSHOT_HPP
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QFile>
+#include <QtCore/QRunnable>
+
+#include "contactlistentry.hpp"
+
+/**
+ * Memory-mapped snapshot of the contact list, used to show the list
+ * immediately on startup while it is reloaded from the contact service.
+ *
+ * The file holds a header, a fixed size record per row, and a table of
+ * the distinct strings followed by their UTF-16 data. Strings returned by
+ * entries() refer directly to the mapped file, so the snapshot must stay
+ * open for as long as they are in use.
+ */
+class ContactListSnapshot
+{
+public:
+    ContactListSnapshot();
+    ~ContactListSnapshot();
+
+    /**
+     * Maps an existing snapshot file, returning false if it is missing or
+     * was not written by this version of the application.
+     */
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return data_ != 0; }
+
+    QList<ContactListEntry> entries() const;
+
+    /**
+     * Writes a snapshot of the entries, replacing any existing file. The
+     * new file is written under a temporary name and renamed into place,
+     * so an open mapping of the previous snapshot remains valid.
+     */
+    static bool write(const QString &fileName, const QList<ContactListEntry> &entries);
+
+private:
+    Q_DISABLE_COPY(ContactListSnapshot)
+    QFile file_;
+    const uchar *data_;
+    qint64 size_;
+};
+
+/**
+ * Writes a snapshot on a thread pool thread.
+ */
+class ContactListSnapshotWriter : public QRunnable
+{
+public:
+    ContactListSnapshotWriter(const QString &fileName, const QList<ContactListEntry> &entries)
+        : fileName_(fileName), entries_(entries) { }
+    virtual void run();
+private:
+    QString fileName_;
+    QList<ContactListEntry> entries_;
+};
+
+#endif // CONTACTLISTSNAPSHOT_HPP
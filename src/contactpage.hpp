@@ -3,14 +3,15 @@
 
 #include <QtCore/QObject>
 
-#include <bb/pim/contacts/Contact>
-#include <bb/pim/contacts/ContactAttribute>
+#include "contactlistentry.hpp"
+#include "contactdetails.hpp"
 
 namespace bb { namespace cascades {
 class Page;
 class NavigationPane;
 class ListView;
 class GroupDataModel;
+class ActionItem;
 }}
 
 class ContactPage : public QObject
@@ -19,6 +20,7 @@ class ContactPage : public QObject
 public:
     ContactPage(int contactId, QObject *parent=0);
     virtual ~ContactPage();
+    void setHeader(const ContactListEntry &entry);
     void push(bb::cascades::NavigationPane *navPane);
 private slots:
     void onPropertiesSelected();
@@ -26,20 +28,20 @@ private slots:
     void onSaveData();
     void onPickerFileSelected(const QStringList& selectedFiles);
     void onPickerCanceled();
+    void onDetailsLoaded(int contactId, const ContactDetails &details);
+    void onImageReady(const QString &filePath);
 private:
     void populateContactFields();
-    void populateContactProperties(const bb::pim::contacts::Contact &contact);
-    void populateContactAttributes(const bb::pim::contacts::Contact &contact);
-    void populateExportData(const bb::pim::contacts::Contact &contact);
-    static QString attributeKindName(bb::pim::contacts::AttributeKind::Type kind);
-    static QString attributeSubKindName(bb::pim::contacts::AttributeSubKind::Type subKind);
+    static QVariantMap withPhoto(const QVariantMap &map);
     int contactId_;
     bb::cascades::Page *page_;
     bb::cascades::NavigationPane *navPane_;
     bb::cascades::ListView *listView_;
     bb::cascades::GroupDataModel *propertiesModel_;
     bb::cascades::GroupDataModel *attributesModel_;
-    QByteArray exportData_;
+    bb::cascades::ActionItem *saveAction_;
+    ContactRecord contact_;
+    QString headerPhotoFilepath_;
 };
 
 #endif // CONTACTPAGE_HPP
@@ -0,0 +1,89 @@
+#ifndef CONTACTRECORD_HPP
+#define CONTACTRECORD_HPP
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+
+#include "contactlistentry.hpp"
+
+struct ContactRecordAttribute
+{
+    ContactRecordAttribute() : id(0), kind(0), subKind(0) { }
+    int id;
+    int kind;
+    int subKind;
+    QString kindName;
+    QString subKindName;
+    QString label;
+    QString value;
+    QList<int> sources;
+};
+
+struct ContactRecordPhoto
+{
+    ContactRecordPhoto() : id(0), sourceAccountId(0) { }
+    int id;
+    int sourceAccountId;
+    QString smallPhotoFilepath;
+};
+
+struct ContactRecordAccount
+{
+    ContactRecordAccount() : id(0) { }
+    int id;
+    QString displayName;
+    QString providerId;
+    QString providerName;
+};
+
+struct ContactRecordAddress
+{
+    QString label;
+    QString line1;
+    QString line2;
+    QString city;
+    QString region;
+    QString country;
+};
+
+/**
+ * All the details of a single contact, independent of where they were read
+ * from. Attribute kinds and source accounts are resolved to their names by
+ * the ContactSource that produced the record.
+ *
+ * As with the contact service, emails and phone numbers are also found
+ * among the attributes.
+ */
+struct ContactRecord
+{
+    ContactRecord() : id(0), accountId(0), primaryPhotoId(0) { }
+
+    bool isValid() const { return id != 0; }
+
+    ContactListEntry listEntry() const
+    {
+        ContactListEntry entry;
+        entry.contactId = id;
+        entry.displayName = displayName;
+        entry.displayCompanyName = displayCompanyName;
+        entry.photoFilepath = smallPhotoFilepath;
+        return entry;
+    }
+
+    int id;
+    int accountId;
+    QString displayName;
+    QString displayCompanyName;
+    QString firstName;
+    QString lastName;
+    QString smallPhotoFilepath;
+    int primaryPhotoId;
+    QList<ContactRecordAccount> sourceAccounts;
+    QList<ContactRecordAttribute> attributes;
+    QList<ContactRecordAttribute> emails;
+    QList<ContactRecordAttribute> phoneNumbers;
+    QList<ContactRecordPhoto> photos;
+    QList<ContactRecordAddress> postalAddresses;
+};
+
+#endif // CONTACTRECORD_HPP
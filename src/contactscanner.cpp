@@ -0,0 +1,124 @@
+#include "contactscanner.hpp"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QMutexLocker>
+
+namespace
+{
+const int PageSize = 100;
+const int MaximumPagesInFlight = 4;
+}
+
+class ContactScanTask : public QRunnable
+{
+public:
+    ContactScanTask(ContactScanner *scanner, int index, const QList<int> &contactIds)
+        : scanner_(scanner), index_(index), contactIds_(contactIds) { }
+    void run()
+    {
+        QList<ContactRecord> contacts;
+        contacts.reserve(contactIds_.size());
+        foreach(int contactId, contactIds_) {
+            const ContactRecord contact = scanner_->source_->contactDetails(contactId);
+            if(contact.isValid()) {
+                contacts.append(contact);
+            }
+        }
+
+        ContactScanner::PageResult result;
+        result.data = scanner_->handler_->processPage(contacts);
+        result.contactCount = contacts.size();
+        scanner_->pageProcessed(index_, result);
+    }
+private:
+    ContactScanner *scanner_;
+    int index_;
+    QList<int> contactIds_;
+};
+
+ContactScanner::ContactScanner(const ContactSourcePointer &source, ContactScanHandler *handler, QObject *parent)
+    : QObject(parent), source_(source), handler_(handler), canceled_(0), maxThreadCount_(0)
+{
+}
+
+ContactScanner::~ContactScanner()
+{
+    delete handler_;
+}
+
+void ContactScanner::cancel()
+{
+    canceled_.fetchAndStoreRelaxed(1);
+}
+
+void ContactScanner::start()
+{
+    QThreadPool workerPool;
+    workerPool.setMaxThreadCount(maxThreadCount_ > 0 ? maxThreadCount_ : qMax(2, QThread::idealThreadCount()));
+
+    int anchorContactId = 0;
+    int dispatched = 0;
+    int consumed = 0;
+    int contactCount = 0;
+    bool morePages = true;
+    bool success = true;
+
+    while(morePages || consumed < dispatched) {
+        if(canceled_) {
+            success = false;
+            break;
+        }
+
+        // Keep reading ahead while there is room for more pages in flight
+        if(morePages && dispatched - consumed < MaximumPagesInFlight) {
+            const QVector<ContactListEntry> entries = source_->listEntries(anchorContactId, PageSize);
+            if(entries.size() == PageSize) {
+                anchorContactId = entries.last().contactId;
+            }
+            else {
+                morePages = false;
+            }
+
+            if(!entries.isEmpty()) {
+                QList<int> contactIds;
+                contactIds.reserve(entries.size());
+                foreach(const ContactListEntry &entry, entries) {
+                    contactIds.append(entry.contactId);
+                }
+                workerPool.start(new ContactScanTask(this, dispatched, contactIds));
+                dispatched++;
+            }
+            continue;
+        }
+
+        PageResult result;
+        {
+            QMutexLocker locker(&mutex_);
+            while(!results_.contains(consumed)) {
+                resultReady_.wait(&mutex_);
+            }
+            result = results_.take(consumed);
+        }
+        consumed++;
+
+        if(!handler_->consumePage(result.data)) {
+            success = false;
+            break;
+        }
+        contactCount += result.contactCount;
+        emit progress(contactCount);
+    }
+
+    workerPool.waitForDone();
+    success = handler_->finish(success);
+    emit finished(success);
+}
+
+void ContactScanner::pageProcessed(int index, const PageResult &result)
+{
+    QMutexLocker locker(&mutex_);
+    results_.insert(index, result);
+    resultReady_.wakeAll();
+}
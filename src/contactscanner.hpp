@@ -0,0 +1,91 @@
+#ifndef CONTACTSCANNER_HPP
+#define CONTACTSCANNER_HPP
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QAtomicInt>
+
+#include "contactrecord.hpp"
+#include "contactsource.hpp"
+
+/**
+ * Receives the contacts visited by a ContactScanner.
+ */
+class ContactScanHandler
+{
+public:
+    virtual ~ContactScanHandler() { }
+
+    /**
+     * Processes a page of fully populated contacts. Called concurrently
+     * from worker threads, so implementations must be thread-safe.
+     */
+    virtual QByteArray processPage(const QList<ContactRecord> &contacts) = 0;
+
+    /**
+     * Receives the results of processPage(), one page at a time and in
+     * the order the pages were read. Returning false stops the scan.
+     */
+    virtual bool consumePage(const QByteArray &result) { Q_UNUSED(result); return true; }
+
+    /**
+     * Called once the scan has ended, whether or not it succeeded, which
+     * it did not if it was canceled or a page could not be consumed.
+     * Returning false fails a scan that had succeeded so far.
+     */
+    virtual bool finish(bool success) { return success; }
+};
+
+/**
+ * Visits every contact of a contact source with full details.
+ *
+ * Pages of contact IDs are read on the scanner's own thread, while the
+ * details of each page are retrieved and processed on a pool of worker
+ * threads. Only a small, fixed number of pages is in flight at a time,
+ * which bounds memory use regardless of the size of the database.
+ */
+class ContactScanner : public QObject
+{
+    Q_OBJECT
+public:
+    ContactScanner(const ContactSourcePointer &source, ContactScanHandler *handler, QObject *parent=0);
+    virtual ~ContactScanner();
+
+    /**
+     * Stops the scan after the pages currently in flight. May be called
+     * from any thread.
+     */
+    void cancel();
+
+    /**
+     * Sets the number of worker threads, which is otherwise chosen from
+     * the number of processor cores.
+     */
+    void setMaxThreadCount(int count) { maxThreadCount_ = count; }
+public slots:
+    void start();
+signals:
+    void progress(int contactCount);
+    void finished(bool success);
+private:
+    friend class ContactScanTask;
+    struct PageResult
+    {
+        PageResult() : contactCount(0) { }
+        QByteArray data;
+        int contactCount;
+    };
+    void pageProcessed(int index, const PageResult &result);
+    ContactSourcePointer source_;
+    ContactScanHandler *handler_;
+    QMutex mutex_;
+    QWaitCondition resultReady_;
+    QMap<int, PageResult> results_;
+    QAtomicInt canceled_;
+    int maxThreadCount_;
+};
+
+#endif // CONTACTSCANNER_HPP
@@ -0,0 +1,204 @@
+#include "contactsearchindex.hpp"
+
+#include <QtCore/QtAlgorithms>
+
+namespace
+{
+const int MaximumGramLength = 3;
+
+// Once this few candidates remain, verifying them directly is cheaper
+// than intersecting further posting lists.
+const int VerifyCandidateCount = 64;
+
+bool shorterPostings(const QVector<int> *list1, const QVector<int> *list2)
+{
+    return list1->size() < list2->size();
+}
+
+QVector<int> intersectPostings(const QVector<int> &list1, const QVector<int> &list2)
+{
+    QVector<int> result;
+    result.reserve(qMin(list1.size(), list2.size()));
+    int i = 0;
+    int j = 0;
+    while(i < list1.size() && j < list2.size()) {
+        if(list1[i] < list2[j]) {
+            i++;
+        }
+        else if(list2[j] < list1[i]) {
+            j++;
+        }
+        else {
+            result.append(list1[i]);
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+}
+
+ContactSearchIndex::ContactSearchIndex()
+{
+}
+
+void ContactSearchIndex::add(int contactId, const QString &displayName, const QString &displayCompanyName)
+{
+    if(docIds_.contains(contactId)) {
+        remove(contactId);
+    }
+
+    const int doc = contactIds_.size();
+    const QString name = normalize(displayName);
+    const QString company = normalize(displayCompanyName);
+    contactIds_.append(contactId);
+    texts_.append(name + QLatin1Char('\n') + company);
+    removed_.append(false);
+    docIds_.insert(contactId, doc);
+
+    addGrams(doc, name);
+    addGrams(doc, company);
+}
+
+void ContactSearchIndex::remove(int contactId)
+{
+    QHash<int, int>::iterator it = docIds_.find(contactId);
+    if(it == docIds_.end()) { return; }
+
+    // Posting lists still refer to the document, but removed documents
+    // are skipped when collecting results.
+    const int doc = it.value();
+    removed_[doc] = true;
+    texts_[doc] = QString();
+    docIds_.erase(it);
+}
+
+void ContactSearchIndex::clear()
+{
+    contactIds_.clear();
+    texts_.clear();
+    removed_.clear();
+    docIds_.clear();
+    postings_.clear();
+}
+
+QList<int> ContactSearchIndex::search(const QString &text) const
+{
+    QList<int> results;
+    const QString trimmed = text.trimmed();
+    if(trimmed.isEmpty()) { return results; }
+
+    bool isNumber = false;
+    const int contactId = trimmed.toInt(&isNumber);
+    const int idDoc = isNumber ? docIds_.value(contactId, -1) : -1;
+
+    const QString query = normalize(trimmed);
+    QVector<int> matches;
+    if(query.length() <= MaximumGramLength) {
+        const QVector<int> *list = postings(gram(query.constData(), query.length()));
+        if(list) {
+            matches = *list;
+        }
+    }
+    else {
+        QList<const QVector<int> *> lists;
+        for(int i = 0; i + MaximumGramLength <= query.length(); i++) {
+            const QVector<int> *list = postings(gram(query.constData() + i, MaximumGramLength));
+            if(!list) {
+                lists.clear();
+                break;
+            }
+            lists.append(list);
+        }
+
+        if(!lists.isEmpty()) {
+            qSort(lists.begin(), lists.end(), shorterPostings);
+            QVector<int> candidates = *lists[0];
+            for(int i = 1; i < lists.size() && candidates.size() > VerifyCandidateCount; i++) {
+                candidates = intersectPostings(candidates, *lists[i]);
+            }
+
+            // N-grams only narrow down the candidates, so confirm the match
+            foreach(int doc, candidates) {
+                if(texts_[doc].contains(query)) {
+                    matches.append(doc);
+                }
+            }
+        }
+    }
+
+    if(idDoc >= 0) {
+        results.append(contactIds_[idDoc]);
+    }
+    foreach(int doc, matches) {
+        if(!removed_[doc] && doc != idDoc) {
+            results.append(contactIds_[doc]);
+        }
+    }
+    return results;
+}
+
+bool ContactSearchIndex::contains(int contactId, const QString &normalizedQuery) const
+{
+    const int doc = docIds_.value(contactId, -1);
+    return doc >= 0 && texts_[doc].contains(normalizedQuery);
+}
+
+QString ContactSearchIndex::normalize(const QString &text)
+{
+    bool ascii = true;
+    const int length = text.length();
+    const QChar *data = text.constData();
+    for(int i = 0; i < length; i++) {
+        if(data[i].unicode() >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+    if(ascii) {
+        return text.toLower();
+    }
+
+    // Decompose accented characters and drop the combining marks
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposed.length());
+    for(int i = 0; i < decomposed.length(); i++) {
+        if(decomposed[i].category() != QChar::Mark_NonSpacing) {
+            result.append(decomposed[i]);
+        }
+    }
+    return result.toCaseFolded();
+}
+
+ContactSearchIndex::Gram ContactSearchIndex::gram(const QChar *data, int length)
+{
+    Gram key = Gram(length) << 48;
+    for(int i = 0; i < length; i++) {
+        key |= Gram(data[i].unicode()) << (16 * (MaximumGramLength - 1 - i));
+    }
+    return key;
+}
+
+void ContactSearchIndex::addGrams(int doc, const QString &field)
+{
+    const int length = field.length();
+    const QChar *data = field.constData();
+    for(int i = 0; i < length; i++) {
+        for(int n = 1; n <= MaximumGramLength && i + n <= length; n++) {
+            QVector<int> &list = postings_[gram(data + i, n)];
+            if(list.isEmpty() || list.last() != doc) {
+                list.append(doc);
+            }
+        }
+    }
+}
+
+const QVector<int> *ContactSearchIndex::postings(Gram key) const
+{
+    QHash<Gram, QVector<int> >::const_iterator it = postings_.constFind(key);
+    if(it == postings_.constEnd()) {
+        return 0;
+    }
+    return &it.value();
+}
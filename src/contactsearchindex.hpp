@@ -0,0 +1,56 @@
+#ifndef CONTACTSEARCHINDEX_HPP
+#define CONTACTSEARCHINDEX_HPP
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+
+/**
+ * Substring search index over contact display names and company names.
+ *
+ * Text is normalized by stripping diacritics and case folding, and every
+ * 1, 2 and 3 character n-gram of each field maps to the sorted list of
+ * contacts containing it. Queries of up to three characters are answered
+ * directly from a single posting list, while longer queries intersect the
+ * posting lists of their n-grams and verify the remaining candidates.
+ * Contacts can also be found by their exact ID.
+ */
+class ContactSearchIndex
+{
+public:
+    ContactSearchIndex();
+
+    void add(int contactId, const QString &displayName, const QString &displayCompanyName);
+    void remove(int contactId);
+    void clear();
+    int size() const { return docIds_.size(); }
+
+    /**
+     * Returns the IDs of all contacts matching the text, in the order in
+     * which they were added to the index.
+     */
+    QList<int> search(const QString &text) const;
+
+    /**
+     * Returns whether a contact's names contain a query that has already
+     * been passed through normalize().
+     */
+    bool contains(int contactId, const QString &normalizedQuery) const;
+
+    static QString normalize(const QString &text);
+
+private:
+    typedef quint64 Gram;
+    static Gram gram(const QChar *data, int length);
+    void addGrams(int doc, const QString &field);
+    const QVector<int> *postings(Gram key) const;
+
+    QVector<int> contactIds_;
+    QVector<QString> texts_;
+    QVector<bool> removed_;
+    QHash<int, int> docIds_;
+    QHash<Gram, QVector<int> > postings_;
+};
+
+#endif // CONTACTSEARCHINDEX_HPP
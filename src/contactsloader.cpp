@@ -0,0 +1,321 @@
+#include "contactsloader.hpp"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QSet>
+
+#include "trace.hpp"
+
+namespace
+{
+const int InitialPageSize = 50;
+const int MinimumPageSize = 50;
+const int MaximumPageSize = 1000;
+const int TargetFetchMsecs = 250;
+const int TargetConsumeMsecs = 40;
+const int MaximumPendingPages = 2;
+
+// Pages of a partition read ahead of the merge, including the one being
+// fetched
+const int MaximumPartitionPages = 2;
+
+typedef QSharedPointer<QVector<ContactListEntry> > EntriesPointer;
+
+int fetchPageSize(int pageSize, qint64 fetchMsecs)
+{
+    int size = pageSize * 2;
+    if(fetchMsecs > 0) {
+        size = qMin(size, int(pageSize * TargetFetchMsecs / fetchMsecs));
+    }
+    return qBound(MinimumPageSize, size, MaximumPageSize);
+}
+
+struct PageResult
+{
+    PageResult() : elapsedMsecs(0) { }
+    EntriesPointer entries;
+    qint64 elapsedMsecs;
+    QSemaphore ready;
+};
+
+class PageFetch : public QRunnable
+{
+public:
+    PageFetch(const ContactSourcePointer &source, int anchorContactId, int limit, QSharedPointer<PageResult> result)
+        : source_(source), anchorContactId_(anchorContactId), limit_(limit), result_(result) { }
+    void run()
+    {
+        TRACE_SCOPE("loader", "fetchPage");
+        QElapsedTimer timer;
+        timer.start();
+        result_->entries = EntriesPointer(new QVector<ContactListEntry>(source_->listEntries(anchorContactId_, limit_)));
+        result_->elapsedMsecs = timer.elapsed();
+        TRACE_COUNTER("loader", "pageSize", result_->entries->size());
+        result_->ready.release();
+    }
+private:
+    ContactSourcePointer source_;
+    int anchorContactId_;
+    int limit_;
+    QSharedPointer<PageResult> result_;
+};
+
+struct PartitionStream
+{
+    PartitionStream() : done(false), space(MaximumPartitionPages) { }
+    QList<EntriesPointer> pages;
+    bool done;
+    QSemaphore space;
+};
+
+struct PartitionStreams
+{
+    ~PartitionStreams()
+    {
+        qDeleteAll(streams);
+    }
+    QMutex mutex;
+    QWaitCondition pageAdded;
+    QVector<PartitionStream *> streams;
+};
+
+class PartitionFetch : public QRunnable
+{
+public:
+    PartitionFetch(const ContactSourcePointer &source, int partition, int index,
+        PartitionStreams *streams, const QAtomicInt *canceled)
+        : source_(source), partition_(partition), index_(index), streams_(streams), canceled_(canceled) { }
+    void run()
+    {
+        // Each partition is read ahead of the merge by a few pages at most,
+        // waiting for the merge to take one before fetching another.
+        PartitionStream *stream = streams_->streams[index_];
+        int pageSize = InitialPageSize;
+        int anchorContactId = 0;
+        bool more = true;
+        while(more) {
+            stream->space.acquire();
+            if(*canceled_) { break; }
+
+            QElapsedTimer timer;
+            timer.start();
+            EntriesPointer entries;
+            {
+                TRACE_SCOPE("loader", "fetchPartitionPage");
+                entries = EntriesPointer(new QVector<ContactListEntry>(
+                    source_->listPartitionEntries(partition_, anchorContactId, pageSize)));
+            }
+
+            more = entries->size() == pageSize;
+            if(more) {
+                anchorContactId = entries->last().contactId;
+                pageSize = fetchPageSize(pageSize, timer.elapsed());
+            }
+            if(!entries->isEmpty()) {
+                QMutexLocker locker(&streams_->mutex);
+                stream->pages.append(entries);
+                streams_->pageAdded.wakeAll();
+            }
+            else {
+                stream->space.release();
+            }
+        }
+
+        QMutexLocker locker(&streams_->mutex);
+        stream->done = true;
+        streams_->pageAdded.wakeAll();
+    }
+private:
+    ContactSourcePointer source_;
+    int partition_;
+    int index_;
+    PartitionStreams *streams_;
+    const QAtomicInt *canceled_;
+};
+}
+
+ContactsLoader::ContactsLoader(const ContactSourcePointer &source, int generation, QObject *parent)
+    : QObject(parent), source_(source), generation_(generation), partitioned_(false),
+    pageSlots_(MaximumPendingPages),
+    consumeMsecsPerHundred_(0), pendingPages_(0), canceled_(0)
+{
+}
+
+void ContactsLoader::pageConsumed(int contactCount, qint64 elapsedMsecs)
+{
+    if(contactCount > 0) {
+        consumeMsecsPerHundred_.fetchAndStoreRelaxed(qMax(1, int(elapsedMsecs * 100 / contactCount)));
+    }
+    const int pendingPages = pendingPages_.fetchAndAddRelaxed(-1) - 1;
+    TRACE_COUNTER("loader", "pendingPages", pendingPages);
+    Q_UNUSED(pendingPages);
+    pageSlots_.release();
+}
+
+void ContactsLoader::cancel()
+{
+    canceled_.fetchAndStoreRelaxed(1);
+
+    // Wake the loader if it is waiting for the receiver, which will not
+    // acknowledge any more pages.
+    pageSlots_.release();
+}
+
+void ContactsLoader::start()
+{
+    TRACE_SCOPE("loader", "load");
+    const QList<int> partitions = partitioned_ ? source_->partitions() : QList<int>();
+    if(partitions.size() > 1) {
+        loadPartitions(partitions);
+    }
+    else {
+        loadSequential();
+    }
+    emit finished(generation_);
+}
+
+void ContactsLoader::loadSequential()
+{
+    // A single fetch thread keeps page requests in order, while still
+    // letting the next request run concurrently with delivery of the
+    // current page.
+    QThreadPool fetchPool;
+    fetchPool.setMaxThreadCount(1);
+
+    int pageSize = InitialPageSize;
+    QSharedPointer<PageResult> pending(new PageResult());
+    fetchPool.start(new PageFetch(source_, 0, pageSize, pending));
+
+    while(pending) {
+        pending->ready.acquire();
+        QSharedPointer<PageResult> current = pending;
+        pending.clear();
+        if(canceled_) { break; }
+
+        if(current->entries->size() == pageSize) {
+            const int anchorContactId = current->entries->last().contactId;
+            pageSize = nextPageSize(pageSize, current->elapsedMsecs);
+            pending = QSharedPointer<PageResult>(new PageResult());
+            fetchPool.start(new PageFetch(source_, anchorContactId, pageSize, pending));
+        }
+
+        if(!deliver(current->entries)) { break; }
+    }
+
+    // Waits for any request still in progress when canceled
+    fetchPool.waitForDone();
+}
+
+void ContactsLoader::loadPartitions(const QList<int> &partitions)
+{
+    const int count = partitions.size();
+    PartitionStreams streams;
+    streams.streams.reserve(count);
+    for(int i = 0; i < count; i++) {
+        streams.streams.append(new PartitionStream());
+    }
+
+    // Every partition has a thread of its own, since the merge needs the
+    // next page of each one, and a partition left waiting for a thread
+    // would stall it while the others wait for the merge.
+    QThreadPool fetchPool;
+    fetchPool.setMaxThreadCount(count);
+    for(int i = 0; i < count; i++) {
+        fetchPool.start(new PartitionFetch(source_, partitions[i], i, &streams, &canceled_));
+    }
+
+    // The page of each partition being merged, and the next entry in it
+    QVector<EntriesPointer> heads(count);
+    QVector<int> positions(count, 0);
+    QSet<int> delivered;
+
+    int pageSize = InitialPageSize;
+    EntriesPointer page(new QVector<ContactListEntry>());
+    while(!canceled_) {
+        // Every partition with entries left has to contribute its next
+        // one before the merge can move on.
+        for(int i = 0; i < count; i++) {
+            if(positions[i] < (heads[i] ? heads[i]->size() : 0)) { continue; }
+            heads[i].clear();
+
+            TRACE_SCOPE("loader", "waitForPartition");
+            QMutexLocker locker(&streams.mutex);
+            PartitionStream *stream = streams.streams[i];
+            while(stream->pages.isEmpty() && !stream->done) {
+                streams.pageAdded.wait(&streams.mutex);
+            }
+            if(!stream->pages.isEmpty()) {
+                heads[i] = stream->pages.takeFirst();
+                positions[i] = 0;
+                stream->space.release();
+            }
+        }
+        if(canceled_) { break; }
+
+        int next = -1;
+        for(int i = 0; i < count; i++) {
+            if(heads[i] && (next < 0
+                || entryLessThan(heads[i]->at(positions[i]), heads[next]->at(positions[next])))) {
+                next = i;
+            }
+        }
+        if(next < 0) { break; }
+
+        const ContactListEntry &entry = heads[next]->at(positions[next]);
+        positions[next]++;
+        if(!delivered.contains(entry.contactId)) {
+            delivered.insert(entry.contactId);
+            page->append(entry);
+        }
+
+        if(page->size() >= pageSize) {
+            if(!deliver(page)) { break; }
+            pageSize = nextPageSize(pageSize, 0);
+            page = EntriesPointer(new QVector<ContactListEntry>());
+        }
+    }
+    if(!canceled_ && !page->isEmpty()) {
+        deliver(page);
+    }
+
+    // Partitions still being read when canceled may be waiting for the
+    // merge to take a page, so they are let through to see the cancel
+    foreach(PartitionStream *stream, streams.streams) {
+        stream->space.release(MaximumPartitionPages);
+    }
+    fetchPool.waitForDone();
+}
+
+bool ContactsLoader::deliver(const ContactListPage &page)
+{
+    // Wait for the receiver to catch up before handing over more pages
+    {
+        TRACE_SCOPE("loader", "waitForReceiver");
+        pageSlots_.acquire();
+    }
+    if(canceled_) { return false; }
+    const int pendingPages = pendingPages_.fetchAndAddRelaxed(1) + 1;
+    TRACE_COUNTER("loader", "pendingPages", pendingPages);
+    Q_UNUSED(pendingPages);
+    emit pageLoaded(generation_, page);
+    return true;
+}
+
+int ContactsLoader::nextPageSize(int pageSize, qint64 fetchMsecs) const
+{
+    int size = fetchPageSize(pageSize, fetchMsecs);
+
+    // Keep each page small enough that the receiver can process it
+    // without stalling its thread for too long.
+    const int consumeCost = consumeMsecsPerHundred_;
+    if(consumeCost > 0) {
+        size = qMin(size, TargetConsumeMsecs * 100 / consumeCost);
+    }
+
+    return qBound(MinimumPageSize, size, MaximumPageSize);
+}
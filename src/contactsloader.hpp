@@ -0,0 +1,78 @@
+#ifndef CONTACTSLOADER_HPP
+#define CONTACTSLOADER_HPP
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QSemaphore>
+#include <QtCore/QAtomicInt>
+
+#include "contactlistentry.hpp"
+#include "contactsource.hpp"
+
+/**
+ * Loads the full contact list from a contact source, one page at a time.
+ * Pages only hold the fields shown in the list, and are shared with the
+ * receiving thread rather than copied.
+ *
+ * The request for the next page is issued as soon as the previous page
+ * arrives, so it is in flight while the previous page is being delivered.
+ * The page size adapts to the measured service latency and to the cost of
+ * consuming pages on the receiving side, which must acknowledge every
+ * page it receives by calling pageConsumed().
+ *
+ * In partitioned mode, the partitions of the source are each fetched on
+ * a worker thread of their own, a couple of pages ahead of the merge, and
+ * their pages are merged back into a single stream in display name order,
+ * with contacts found in more than one partition delivered only once.
+ *
+ * Every page is tagged with the generation the loader was created with,
+ * so that a receiver which has moved on to a newer load can recognize and
+ * drop pages still queued from an abandoned one.
+ */
+class ContactsLoader : public QObject
+{
+    Q_OBJECT
+public:
+    ContactsLoader(const ContactSourcePointer &source, int generation, QObject *parent=0);
+    virtual ~ContactsLoader() { }
+
+    /**
+     * Acknowledges a page delivered by pageLoaded(), reporting how long it
+     * took to process. May be called from any thread.
+     */
+    void pageConsumed(int contactCount, qint64 elapsedMsecs);
+
+    /**
+     * Stops the load once the request in progress returns, without
+     * delivering any further pages. The loader still emits finished().
+     * May be called from any thread.
+     */
+    void cancel();
+
+    int generation() const { return generation_; }
+
+    /**
+     * Fetches the partitions of the source in parallel, if it has more
+     * than one. Must be set before the load starts.
+     */
+    void setPartitioned(bool partitioned) { partitioned_ = partitioned; }
+public slots:
+    void start();
+signals:
+    void pageLoaded(int generation, const ContactListPage &page);
+    void finished(int generation);
+private:
+    void loadSequential();
+    void loadPartitions(const QList<int> &partitions);
+    bool deliver(const ContactListPage &page);
+    int nextPageSize(int pageSize, qint64 fetchMsecs) const;
+    ContactSourcePointer source_;
+    const int generation_;
+    bool partitioned_;
+    QSemaphore pageSlots_;
+    QAtomicInt consumeMsecsPerHundred_;
+    QAtomicInt pendingPages_;
+    QAtomicInt canceled_;
+};
+
+#endif // CONTACTSLOADER_HPP
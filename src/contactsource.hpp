@@ -0,0 +1,57 @@
+#ifndef CONTACTSOURCE_HPP
+#define CONTACTSOURCE_HPP
+
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QSharedPointer>
+
+#include "contactlistentry.hpp"
+#include "contactrecord.hpp"
+
+/**
+ * Where the contacts shown by the application come from.
+ *
+ * Sources are shared by the loaders running on worker threads, so every
+ * method must be safe to call from any thread.
+ */
+class ContactSource
+{
+public:
+    virtual ~ContactSource() { }
+
+    /**
+     * Returns up to limit list entries in display name order, starting
+     * after the contact with the given ID, or from the beginning if it is
+     * zero. A page shorter than the limit is the last one.
+     */
+    virtual QVector<ContactListEntry> listEntries(int anchorContactId, int limit) = 0;
+
+    /**
+     * Returns the keys of partitions that can be listed independently of
+     * each other, and that together hold every contact. A contact may be
+     * in more than one partition. Sources that cannot be split up return
+     * an empty list.
+     */
+    virtual QList<int> partitions() { return QList<int>(); }
+
+    /**
+     * Returns list entries like listEntries(), but only from the contacts
+     * in one partition. Entries must be in the order of entryLessThan(),
+     * as the loader merges partitions in that order.
+     */
+    virtual QVector<ContactListEntry> listPartitionEntries(int partition, int anchorContactId, int limit)
+    {
+        Q_UNUSED(partition);
+        return listEntries(anchorContactId, limit);
+    }
+
+    /**
+     * Returns the full details of a contact, or an invalid record if it
+     * does not exist.
+     */
+    virtual ContactRecord contactDetails(int contactId) = 0;
+};
+
+typedef QSharedPointer<ContactSource> ContactSourcePointer;
+
+#endif // CONTACTSOURCE_HPP
@@ -0,0 +1,306 @@
+#include "contactstatistics.hpp"
+
+#include <QtCore/QThread>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QStringList>
+#include <QtCore/QtAlgorithms>
+
+#include "jsonwriter.hpp"
+
+namespace
+{
+// Largest contacts kept for each of the rankings
+const int RankingSize = 10;
+
+int stringBytes(const QString &str)
+{
+    return str.length() * int(sizeof(QChar));
+}
+
+int attributeBytes(const QList<ContactRecordAttribute> &attributes)
+{
+    int size = 0;
+    foreach(const ContactRecordAttribute &attribute, attributes) {
+        size += sizeof(ContactRecordAttribute)
+            + stringBytes(attribute.kindName) + stringBytes(attribute.subKindName)
+            + stringBytes(attribute.label) + stringBytes(attribute.value)
+            + attribute.sources.size() * int(sizeof(int));
+    }
+    return size;
+}
+
+/**
+ * Estimates the memory taken by the details of a contact.
+ */
+int recordBytes(const ContactRecord &contact)
+{
+    int size = sizeof(ContactRecord)
+        + stringBytes(contact.displayName) + stringBytes(contact.displayCompanyName)
+        + stringBytes(contact.firstName) + stringBytes(contact.lastName)
+        + stringBytes(contact.smallPhotoFilepath);
+    size += attributeBytes(contact.attributes);
+    size += attributeBytes(contact.emails);
+    size += attributeBytes(contact.phoneNumbers);
+    foreach(const ContactRecordAccount &account, contact.sourceAccounts) {
+        size += sizeof(ContactRecordAccount) + stringBytes(account.displayName)
+            + stringBytes(account.providerId) + stringBytes(account.providerName);
+    }
+    foreach(const ContactRecordPhoto &photo, contact.photos) {
+        size += sizeof(ContactRecordPhoto) + stringBytes(photo.smallPhotoFilepath);
+    }
+    foreach(const ContactRecordAddress &address, contact.postalAddresses) {
+        size += sizeof(ContactRecordAddress) + stringBytes(address.label)
+            + stringBytes(address.line1) + stringBytes(address.line2) + stringBytes(address.city)
+            + stringBytes(address.region) + stringBytes(address.country);
+    }
+    return size;
+}
+
+int histogramBucket(int count)
+{
+    int bucket = 1;
+    while(bucket * 2 <= count) {
+        bucket *= 2;
+    }
+    return count > 0 ? bucket : 0;
+}
+
+bool moreAttributes(const ContactStatisticsEntry &entry1, const ContactStatisticsEntry &entry2)
+{
+    if(entry1.attributeCount != entry2.attributeCount) {
+        return entry1.attributeCount > entry2.attributeCount;
+    }
+    return entry1.contactId < entry2.contactId;
+}
+
+bool largerSize(const ContactStatisticsEntry &entry1, const ContactStatisticsEntry &entry2)
+{
+    if(entry1.byteSize != entry2.byteSize) {
+        return entry1.byteSize > entry2.byteSize;
+    }
+    return entry1.contactId < entry2.contactId;
+}
+
+void rank(QList<ContactStatisticsEntry> &ranking, const ContactStatisticsEntry &entry,
+    bool (*lessThan)(const ContactStatisticsEntry &, const ContactStatisticsEntry &))
+{
+    if(ranking.size() >= RankingSize && !lessThan(entry, ranking.last())) { return; }
+    ranking.insert(qLowerBound(ranking.begin(), ranking.end(), entry, lessThan), entry);
+    if(ranking.size() > RankingSize) {
+        ranking.removeLast();
+    }
+}
+
+template<typename Key>
+void mergeCounts(QHash<Key, qint64> &counts, const QHash<Key, qint64> &other)
+{
+    for(typename QHash<Key, qint64>::const_iterator it = other.constBegin(); it != other.constEnd(); ++it) {
+        counts[it.key()] += it.value();
+    }
+}
+
+void writeRanking(JsonWriter &writer, const QList<ContactStatisticsEntry> &ranking)
+{
+    writer.beginArray();
+    foreach(const ContactStatisticsEntry &entry, ranking) {
+        writer.beginObject();
+        writer.writeName("attributeCount");
+        writer.writeNumber(entry.attributeCount);
+        writer.writeName("byteSize");
+        writer.writeNumber(entry.byteSize);
+        writer.writeName("contactId");
+        writer.writeNumber(entry.contactId);
+        writer.writeName("displayName");
+        writer.writeString(entry.displayName);
+        writer.endObject();
+    }
+    writer.endArray();
+}
+
+void writeCounts(JsonWriter &writer, const QHash<QString, qint64> &counts)
+{
+    QStringList names = counts.keys();
+    qSort(names);
+    writer.beginObject();
+    foreach(const QString &name, names) {
+        writer.writeName(name);
+        writer.writeNumber(counts.value(name));
+    }
+    writer.endObject();
+}
+}
+
+void ContactStatistics::add(const ContactRecord &contact)
+{
+    contactCount++;
+    attributeCount += contact.attributes.size();
+    photoCount += contact.photos.size();
+    if(!contact.photos.isEmpty()) {
+        contactsWithPhotos++;
+    }
+    postalAddressCount += contact.postalAddresses.size();
+
+    foreach(const ContactRecordAttribute &attribute, contact.attributes) {
+        kindCounts[attribute.kindName]++;
+        subKindCounts[attribute.kindName + QLatin1Char('/') + attribute.subKindName]++;
+        foreach(int source, attribute.sources) {
+            accountValueCounts[source]++;
+        }
+    }
+    foreach(const ContactRecordAccount &account, contact.sourceAccounts) {
+        accountContactCounts[account.id]++;
+        if(!accountNames.contains(account.id)) {
+            accountNames.insert(account.id, account.displayName);
+        }
+    }
+    attributeHistogram[histogramBucket(contact.attributes.size())]++;
+
+    ContactStatisticsEntry entry;
+    entry.contactId = contact.id;
+    entry.displayName = contact.displayName;
+    entry.attributeCount = contact.attributes.size();
+    entry.byteSize = recordBytes(contact);
+    byteSize += entry.byteSize;
+    rank(mostAttributes, entry, moreAttributes);
+    rank(largestContacts, entry, largerSize);
+}
+
+void ContactStatistics::merge(const ContactStatistics &other)
+{
+    contactCount += other.contactCount;
+    attributeCount += other.attributeCount;
+    photoCount += other.photoCount;
+    contactsWithPhotos += other.contactsWithPhotos;
+    postalAddressCount += other.postalAddressCount;
+    byteSize += other.byteSize;
+
+    mergeCounts(kindCounts, other.kindCounts);
+    mergeCounts(subKindCounts, other.subKindCounts);
+    mergeCounts(accountContactCounts, other.accountContactCounts);
+    mergeCounts(accountValueCounts, other.accountValueCounts);
+    for(QHash<int, QString>::const_iterator it = other.accountNames.constBegin(); it != other.accountNames.constEnd(); ++it) {
+        if(!accountNames.contains(it.key())) {
+            accountNames.insert(it.key(), it.value());
+        }
+    }
+    for(QMap<int, qint64>::const_iterator it = other.attributeHistogram.constBegin(); it != other.attributeHistogram.constEnd(); ++it) {
+        attributeHistogram[it.key()] += it.value();
+    }
+
+    foreach(const ContactStatisticsEntry &entry, other.mostAttributes) {
+        rank(mostAttributes, entry, moreAttributes);
+    }
+    foreach(const ContactStatisticsEntry &entry, other.largestContacts) {
+        rank(largestContacts, entry, largerSize);
+    }
+}
+
+void ContactStatistics::write(JsonWriter &writer) const
+{
+    // Members are written in sorted order, like the contact export
+    writer.beginObject();
+
+    writer.writeName("accounts");
+    writer.beginArray();
+    QList<int> accountIds = accountContactCounts.keys();
+    foreach(int accountId, accountValueCounts.keys()) {
+        if(!accountContactCounts.contains(accountId)) {
+            accountIds.append(accountId);
+        }
+    }
+    qSort(accountIds);
+    foreach(int accountId, accountIds) {
+        writer.beginObject();
+        writer.writeName("contactCount");
+        writer.writeNumber(accountContactCounts.value(accountId));
+        writer.writeName("displayName");
+        writer.writeString(accountNames.value(accountId));
+        writer.writeName("id");
+        writer.writeNumber(accountId);
+        writer.writeName("valueCount");
+        writer.writeNumber(accountValueCounts.value(accountId));
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.writeName("attributeCount");
+    writer.writeNumber(attributeCount);
+
+    writer.writeName("attributeHistogram");
+    writer.beginArray();
+    for(QMap<int, qint64>::const_iterator it = attributeHistogram.constBegin(); it != attributeHistogram.constEnd(); ++it) {
+        writer.beginObject();
+        writer.writeName("contactCount");
+        writer.writeNumber(it.value());
+        writer.writeName("minimumAttributes");
+        writer.writeNumber(it.key());
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.writeName("byteSize");
+    writer.writeNumber(byteSize);
+    writer.writeName("contactCount");
+    writer.writeNumber(contactCount);
+    writer.writeName("contactsWithPhotos");
+    writer.writeNumber(contactsWithPhotos);
+
+    writer.writeName("kinds");
+    writeCounts(writer, kindCounts);
+
+    writer.writeName("largestContacts");
+    writeRanking(writer, largestContacts);
+    writer.writeName("mostAttributes");
+    writeRanking(writer, mostAttributes);
+
+    writer.writeName("photoCount");
+    writer.writeNumber(photoCount);
+    writer.writeName("postalAddressCount");
+    writer.writeNumber(postalAddressCount);
+
+    writer.writeName("subKinds");
+    writeCounts(writer, subKindCounts);
+
+    writer.endObject();
+}
+
+ContactStatisticsHandler::ContactStatisticsHandler()
+{
+}
+
+ContactStatisticsHandler::~ContactStatisticsHandler()
+{
+    qDeleteAll(threadStatistics_);
+}
+
+QByteArray ContactStatisticsHandler::processPage(const QList<ContactRecord> &contacts)
+{
+    ContactStatistics *statistics;
+    {
+        QMutexLocker locker(&mutex_);
+        ContactStatistics *&threadStatistics = threadStatistics_[QThread::currentThread()];
+        if(!threadStatistics) {
+            threadStatistics = new ContactStatistics();
+        }
+        statistics = threadStatistics;
+    }
+
+    // Only this thread ever touches its own statistics until the merge
+    foreach(const ContactRecord &contact, contacts) {
+        statistics->add(contact);
+    }
+    return QByteArray();
+}
+
+bool ContactStatisticsHandler::finish(bool success)
+{
+    // The worker threads are done by the time the scan finishes
+    QMutexLocker locker(&mutex_);
+    statistics_ = ContactStatistics();
+    foreach(const ContactStatistics *statistics, threadStatistics_) {
+        statistics_.merge(*statistics);
+    }
+    qDeleteAll(threadStatistics_);
+    threadStatistics_.clear();
+    return success;
+}
@@ -0,0 +1,90 @@
+#ifndef CONTACTSTATISTICS_HPP
+#define CONTACTSTATISTICS_HPP
+
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include "contactrecord.hpp"
+#include "contactscanner.hpp"
+
+class JsonWriter;
+class QThread;
+
+/**
+ * A contact standing out in the statistics, by its number of attributes
+ * or by the memory its details take.
+ */
+struct ContactStatisticsEntry
+{
+    ContactStatisticsEntry() : contactId(0), attributeCount(0), byteSize(0) { }
+    int contactId;
+    QString displayName;
+    int attributeCount;
+    int byteSize;
+};
+
+/**
+ * Aggregate counts over a set of contacts.
+ */
+struct ContactStatistics
+{
+    ContactStatistics() : contactCount(0), attributeCount(0), photoCount(0),
+        contactsWithPhotos(0), postalAddressCount(0), byteSize(0) { }
+
+    void add(const ContactRecord &contact);
+    void merge(const ContactStatistics &other);
+    void write(JsonWriter &writer) const;
+
+    int contactCount;
+    qint64 attributeCount;
+    qint64 photoCount;
+    int contactsWithPhotos;
+    qint64 postalAddressCount;
+    qint64 byteSize;
+
+    /** Attributes by kind name, and by kind and sub-kind name */
+    QHash<QString, qint64> kindCounts;
+    QHash<QString, qint64> subKindCounts;
+
+    /** Contacts and attribute values by source account */
+    QHash<int, qint64> accountContactCounts;
+    QHash<int, qint64> accountValueCounts;
+    QHash<int, QString> accountNames;
+
+    /** Contacts by their number of attributes, rounded down to a power of two */
+    QMap<int, qint64> attributeHistogram;
+
+    QList<ContactStatisticsEntry> mostAttributes;
+    QList<ContactStatisticsEntry> largestContacts;
+};
+
+/**
+ * Scan handler that collects statistics over every contact.
+ *
+ * Each worker thread counts the pages it processes into statistics of its
+ * own, so that threads only contend for a lock once per page, and the
+ * counts of all threads are merged once the scan has finished.
+ */
+class ContactStatisticsHandler : public ContactScanHandler
+{
+public:
+    ContactStatisticsHandler();
+    virtual ~ContactStatisticsHandler();
+    virtual QByteArray processPage(const QList<ContactRecord> &contacts);
+    virtual bool finish(bool success);
+
+    /**
+     * Returns the statistics of a finished scan.
+     */
+    const ContactStatistics &statistics() const { return statistics_; }
+
+private:
+    QMutex mutex_;
+    QHash<QThread *, ContactStatistics *> threadStatistics_;
+    ContactStatistics statistics_;
+};
+
+#endif // CONTACTSTATISTICS_HPP
@@ -0,0 +1,199 @@
+#include "detailscache.hpp"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QMetaType>
+
+namespace
+{
+// Total estimated size of the details kept in the cache
+const int CacheBytes = 2 * 1024 * 1024;
+
+// Loads for contacts the list has already moved away from are dropped
+const int MaximumQueuedRequests = 8;
+
+// Contact details come from a single database, so only a couple of
+// loads are run at the same time.
+const int MaximumLoads = 2;
+
+int stringsCost(const QVariantList &rows)
+{
+    int cost = 0;
+    foreach(const QVariant &row, rows) {
+        const QVariantMap map = row.toMap();
+        cost += 64 * (map.size() + 1);
+        for(QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+            cost += 2 * (it.key().length() + it.value().toString().length());
+        }
+    }
+    return cost;
+}
+
+int recordCost(const ContactRecord &contact)
+{
+    int items = 1 + contact.sourceAccounts.size() + contact.attributes.size()
+        + contact.emails.size() + contact.phoneNumbers.size()
+        + contact.photos.size() + contact.postalAddresses.size();
+    int length = contact.displayName.length() + contact.displayCompanyName.length()
+        + contact.firstName.length() + contact.lastName.length()
+        + contact.smallPhotoFilepath.length();
+    foreach(const ContactRecordAccount &account, contact.sourceAccounts) {
+        length += account.displayName.length() + account.providerId.length()
+            + account.providerName.length();
+    }
+    QList<ContactRecordAttribute> attributes = contact.attributes;
+    attributes += contact.emails;
+    attributes += contact.phoneNumbers;
+    foreach(const ContactRecordAttribute &attribute, attributes) {
+        length += attribute.kindName.length() + attribute.subKindName.length()
+            + attribute.label.length() + attribute.value.length();
+    }
+    foreach(const ContactRecordPhoto &photo, contact.photos) {
+        length += photo.smallPhotoFilepath.length();
+    }
+    foreach(const ContactRecordAddress &address, contact.postalAddresses) {
+        length += address.label.length() + address.line1.length() + address.line2.length()
+            + address.city.length() + address.region.length() + address.country.length();
+    }
+    return 64 * items + 2 * length;
+}
+
+class DetailsLoadTask : public QRunnable
+{
+public:
+    DetailsLoadTask(DetailsCache *cache, const ContactSourcePointer &source, int contactId)
+        : cache_(cache), source_(source), contactId_(contactId) { }
+    void run()
+    {
+        const ContactDetails details = ContactDetailsLoader::load(source_, contactId_);
+        QMetaObject::invokeMethod(cache_, "onDetailsLoaded", Qt::QueuedConnection,
+            Q_ARG(int, contactId_), Q_ARG(ContactDetails, details));
+    }
+private:
+    DetailsCache *cache_;
+    ContactSourcePointer source_;
+    int contactId_;
+};
+}
+
+DetailsCache *DetailsCache::instance_ = NULL;
+
+DetailsCache::DetailsCache(const ContactSourcePointer &source, QObject *parent) : QObject(parent),
+    source_(source), details_(CacheBytes), loading_(0)
+{
+    Q_ASSERT(!instance_);
+    instance_ = this;
+    qRegisterMetaType<ContactDetails>("ContactDetails");
+    loadPool_.setMaxThreadCount(MaximumLoads);
+}
+
+DetailsCache::~DetailsCache()
+{
+    queue_.clear();
+    loadPool_.waitForDone();
+    instance_ = NULL;
+}
+
+DetailsCache *DetailsCache::instance()
+{
+    return instance_;
+}
+
+bool DetailsCache::details(int contactId, ContactDetails *details)
+{
+    ContactDetails *cached = details_.object(contactId);
+    if(cached) {
+        *details = *cached;
+        return true;
+    }
+    request(contactId);
+    return false;
+}
+
+void DetailsCache::prefetch(const QList<int> &contactIds)
+{
+    // Requests are served most recent first
+    for(int i = contactIds.size() - 1; i >= 0; i--) {
+        if(!details_.contains(contactIds[i])) {
+            request(contactIds[i]);
+        }
+    }
+}
+
+void DetailsCache::invalidate(const QList<int> &contactIds)
+{
+    foreach(int contactId, contactIds) {
+        details_.remove(contactId);
+
+        // Queued loads have not read anything yet, but running ones may
+        // already have read the old data.
+        if(pending_.contains(contactId) && !queue_.contains(contactId)) {
+            stale_.insert(contactId);
+        }
+    }
+}
+
+void DetailsCache::clear()
+{
+    details_.clear();
+    foreach(int contactId, pending_) {
+        if(!queue_.contains(contactId)) {
+            stale_.insert(contactId);
+        }
+    }
+}
+
+void DetailsCache::setSource(const ContactSourcePointer &source)
+{
+    source_ = source;
+    clear();
+}
+
+void DetailsCache::request(int contactId)
+{
+    if(pending_.contains(contactId)) {
+        // Move a queued request to the front of the line
+        if(queue_.removeOne(contactId)) {
+            queue_.append(contactId);
+        }
+        return;
+    }
+
+    pending_.insert(contactId);
+    queue_.append(contactId);
+    while(queue_.size() > MaximumQueuedRequests) {
+        pending_.remove(queue_.takeFirst());
+    }
+    startLoads();
+}
+
+void DetailsCache::startLoads()
+{
+    while(!queue_.isEmpty() && loading_ < MaximumLoads) {
+        loadPool_.start(new DetailsLoadTask(this, source_, queue_.takeLast()));
+        loading_++;
+    }
+}
+
+void DetailsCache::onDetailsLoaded(int contactId, const ContactDetails &details)
+{
+    loading_--;
+    pending_.remove(contactId);
+
+    // Details read before the contact changed are loaded again, since a
+    // page may still be waiting for them.
+    if(stale_.remove(contactId)) {
+        request(contactId);
+        return;
+    }
+
+    details_.insert(contactId, new ContactDetails(details), cost(details));
+    emit detailsLoaded(contactId, details);
+    startLoads();
+}
+
+int DetailsCache::cost(const ContactDetails &details)
+{
+    return recordCost(details.contact)
+        + stringsCost(details.properties)
+        + stringsCost(details.attributes);
+}
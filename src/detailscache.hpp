@@ -0,0 +1,79 @@
+#ifndef DETAILSCACHE_HPP
+#define DETAILSCACHE_HPP
+
+#include <QtCore/QObject>
+#include <QtCore/QCache>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+
+#include "contactdetails.hpp"
+#include "contactsource.hpp"
+
+/**
+ * Application-wide cache of fully built contact details.
+ *
+ * Details are loaded on a small pool of worker threads, and kept in a
+ * least recently used cache limited by their estimated size in memory.
+ * Contacts near the one the user is about to open can be prefetched, so
+ * that their pages are populated as soon as they are shown. Entries are
+ * dropped when the contacts they belong to change.
+ *
+ * The cache must only be used from the UI thread.
+ */
+class DetailsCache : public QObject
+{
+    Q_OBJECT
+public:
+    DetailsCache(const ContactSourcePointer &source, QObject *parent=0);
+    virtual ~DetailsCache();
+
+    static DetailsCache *instance();
+
+    /**
+     * Returns whether the details of a contact are cached, providing them
+     * if they are. Otherwise they are loaded ahead of any prefetches, and
+     * detailsLoaded() is emitted once they are available.
+     */
+    bool details(int contactId, ContactDetails *details);
+
+    /**
+     * Queues contacts for loading ahead of being asked for, with the
+     * first contact in the list loaded first.
+     */
+    void prefetch(const QList<int> &contactIds);
+
+    /**
+     * Drops the details of contacts that have changed or been removed,
+     * including any that are currently being loaded.
+     */
+    void invalidate(const QList<int> &contactIds);
+    void clear();
+
+    /**
+     * Switches to loading details from another source, dropping
+     * everything loaded from the previous one.
+     */
+    void setSource(const ContactSourcePointer &source);
+
+signals:
+    void detailsLoaded(int contactId, const ContactDetails &details);
+
+private slots:
+    void onDetailsLoaded(int contactId, const ContactDetails &details);
+
+private:
+    void request(int contactId);
+    void startLoads();
+    static int cost(const ContactDetails &details);
+    static DetailsCache *instance_;
+    ContactSourcePointer source_;
+    QThreadPool loadPool_;
+    QCache<int, ContactDetails> details_;
+    QList<int> queue_;
+    QSet<int> pending_;
+    QSet<int> stale_;
+    int loading_;
+};
+
+#endif // DETAILSCACHE_HPP
@@ -0,0 +1,231 @@
+#include "dumpcontactsource.hpp"
+
+#include <cstring>
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QtAlgorithms>
+
+#include "jsonreader.hpp"
+#include "trace.hpp"
+
+namespace
+{
+// Values given to attribute kind names that cannot be looked up
+const int UnknownKindBase = 0x10000;
+
+/**
+ * Reads the list entry of a contact from its line of the dump.
+ */
+bool readEntry(const QByteArray &line, ContactListEntry *entry)
+{
+    // The header comes after the attributes, which have no names of the
+    // same kind, and before the photos and source accounts, whose display
+    // names would otherwise be found. Its members are in sorted order.
+    int position = 0;
+    bool ok = false;
+    const QVariant contactId = JsonReader::findMember(line, "contactId", &position, &ok);
+    if(ok && contactId.type() == QVariant::LongLong) {
+        const QVariant displayCompanyName = JsonReader::findMember(line, "displayCompanyName", &position, &ok);
+        const QVariant displayName = ok ? JsonReader::findMember(line, "displayName", &position, &ok) : QVariant();
+        if(ok) {
+            entry->contactId = contactId.toInt();
+            entry->displayCompanyName = displayCompanyName.toString();
+            entry->displayName = displayName.toString();
+            return true;
+        }
+    }
+
+    const QVariantMap header = JsonReader::parse(line, &ok).toMap().value("header").toMap();
+    if(!ok || !header.contains("contactId")) {
+        return false;
+    }
+    entry->contactId = header.value("contactId").toInt();
+    entry->displayCompanyName = header.value("displayCompanyName").toString();
+    entry->displayName = header.value("displayName").toString();
+    return true;
+}
+}
+
+DumpContactSource::DumpContactSource(const QString &fileName, KindLookup kindLookup, KindLookup subKindLookup)
+    : file_(fileName), kindLookup_(kindLookup), subKindLookup_(subKindLookup),
+      data_(NULL), malformedCount_(0)
+{
+}
+
+DumpContactSource::~DumpContactSource()
+{
+}
+
+bool DumpContactSource::open()
+{
+    if(!file_.open(QIODevice::ReadOnly)) {
+        errorString_ = file_.errorString();
+        return false;
+    }
+    const qint64 size = file_.size();
+    data_ = size > 0 ? file_.map(0, size) : NULL;
+    if(size > 0 && !data_) {
+        errorString_ = file_.errorString();
+        return false;
+    }
+
+    qint64 offset = 0;
+    while(offset < size) {
+        const uchar *start = data_ + offset;
+        const uchar *newline = static_cast<const uchar *>(memchr(start, '\n', size - offset));
+        int length = newline ? int(newline - start) : int(size - offset);
+        const qint64 next = offset + length + 1;
+        if(length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+
+        if(length > 0) {
+            ContactListEntry entry;
+            const QByteArray line = QByteArray::fromRawData(reinterpret_cast<const char *>(start), length);
+            if(readEntry(line, &entry) && !lines_.contains(entry.contactId)) {
+                ContactLine contactLine;
+                contactLine.offset = offset;
+                contactLine.length = length;
+                lines_.insert(entry.contactId, contactLine);
+                entries_.append(entry);
+            }
+            else {
+                malformedCount_++;
+            }
+        }
+        offset = next;
+    }
+
+    qSort(entries_.begin(), entries_.end(), entryLessThan);
+    positions_.reserve(entries_.size());
+    for(int i = 0; i < entries_.size(); i++) {
+        positions_.insert(entries_[i].contactId, i);
+    }
+    return true;
+}
+
+QVector<ContactListEntry> DumpContactSource::listEntries(int anchorContactId, int limit)
+{
+    int first = 0;
+    if(anchorContactId != 0) {
+        first = positions_.value(anchorContactId, entries_.size() - 1) + 1;
+    }
+    const int count = qMax(0, qMin(limit, entries_.size() - first));
+    return entries_.mid(first, count);
+}
+
+ContactRecord DumpContactSource::contactDetails(int contactId)
+{
+    QHash<int, ContactLine>::const_iterator it = lines_.constFind(contactId);
+    if(it == lines_.constEnd()) {
+        return ContactRecord();
+    }
+
+    bool ok = false;
+    const QVariantMap contact = JsonReader::parse(QByteArray::fromRawData(
+        reinterpret_cast<const char *>(data_ + it.value().offset), it.value().length), &ok).toMap();
+    if(!ok) {
+        return ContactRecord();
+    }
+
+    const QVariantMap header = contact.value("header").toMap();
+    ContactRecord record;
+    record.id = contactId;
+    record.accountId = header.value("accountId").toInt();
+    record.displayName = header.value("displayName").toString();
+    record.displayCompanyName = header.value("displayCompanyName").toString();
+
+    foreach(const QVariant &value, contact.value("sourceAccounts").toList()) {
+        const QVariantMap map = value.toMap();
+        ContactRecordAccount account;
+        account.id = map.value("id").toInt();
+        account.displayName = map.value("displayName").toString();
+        account.providerId = map.value("providerId").toString();
+        account.providerName = map.value("providerName").toString();
+        record.sourceAccounts.append(account);
+    }
+
+    foreach(const QVariant &value, contact.value("photos").toList()) {
+        const QVariantMap map = value.toMap();
+        ContactRecordPhoto photo;
+        photo.id = map.value("id").toInt();
+        photo.sourceAccountId = map.value("sourceAccountId").toInt();
+        if(map.value("isPrimary").toBool()) {
+            record.primaryPhotoId = photo.id;
+        }
+        record.photos.append(photo);
+    }
+
+    foreach(const QVariant &value, contact.value("attributes").toList()) {
+        const QVariantMap map = value.toMap();
+        ContactRecordAttribute attribute;
+        attribute.id = map.value("id").toInt();
+        attribute.kindName = map.value("kind").toString();
+        attribute.subKindName = map.value("subKind").toString();
+        attribute.kind = kindValue(kindLookup_, kinds_, attribute.kindName);
+        attribute.subKind = kindValue(subKindLookup_, subKinds_, attribute.subKindName);
+        attribute.label = attribute.subKindName;
+        attribute.value = map.value("value").toString();
+        foreach(const QVariant &source, map.value("sources").toList()) {
+            attribute.sources.append(source.toInt());
+        }
+
+        if(attribute.kindName == QLatin1String("Email")) {
+            record.emails.append(attribute);
+        }
+        else if(attribute.kindName == QLatin1String("Phone")) {
+            record.phoneNumbers.append(attribute);
+        }
+        record.attributes.append(attribute);
+    }
+    return record;
+}
+
+int DumpContactSource::kindValue(KindLookup lookup, QHash<QString, int> &values, const QString &name)
+{
+    if(lookup) {
+        bool ok = false;
+        const int value = lookup(name, &ok);
+        if(ok) { return value; }
+    }
+
+    QMutexLocker locker(&kindMutex_);
+    QHash<QString, int>::const_iterator it = values.constFind(name);
+    if(it != values.constEnd()) {
+        return it.value();
+    }
+    const int value = UnknownKindBase + values.size();
+    values.insert(name, value);
+    return value;
+}
+
+DumpOpener::DumpOpener(const QString &fileName, DumpContactSource::KindLookup kindLookup,
+    DumpContactSource::KindLookup subKindLookup, QObject *parent)
+    : QObject(parent), source_(new DumpContactSource(fileName, kindLookup, subKindLookup))
+{
+}
+
+DumpOpener::~DumpOpener()
+{
+    delete source_;
+}
+
+DumpContactSource *DumpOpener::takeSource()
+{
+    DumpContactSource *source = source_;
+    source_ = NULL;
+    return source;
+}
+
+void DumpOpener::start()
+{
+    TRACE_SCOPE("dump", "open");
+    if(!source_->open()) {
+        errorString_ = source_->errorString();
+        delete source_;
+        source_ = NULL;
+        emit finished(false);
+        return;
+    }
+    emit finished(true);
+}
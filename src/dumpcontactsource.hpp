@@ -0,0 +1,105 @@
+#ifndef DUMPCONTACTSOURCE_HPP
+#define DUMPCONTACTSOURCE_HPP
+
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+#include "contactsource.hpp"
+
+/**
+ * Contact source reading from an export of the whole database, as written
+ * by BulkExportHandler, for inspecting a dump taken on another device.
+ *
+ * The file is memory-mapped when opened, and only the header of each
+ * contact is read to build the list, along with the position of its line.
+ * The details of a contact are parsed from its line whenever they are
+ * asked for, so opening a dump costs little more than reading through it.
+ *
+ * Exports only name attribute kinds and sub-kinds, which are turned back
+ * into values by the lookups given to the source. Names they do not know,
+ * or all names when there are no lookups, are given values of their own
+ * outside the range used by the contact service.
+ */
+class DumpContactSource : public ContactSource
+{
+public:
+    /**
+     * Returns the value of an attribute kind or sub-kind name, setting ok
+     * to false if the name is unknown.
+     */
+    typedef int (*KindLookup)(const QString &name, bool *ok);
+
+    DumpContactSource(const QString &fileName, KindLookup kindLookup=0, KindLookup subKindLookup=0);
+    virtual ~DumpContactSource();
+
+    /**
+     * Maps and indexes the dump, returning false if it cannot be read.
+     * Must be called before the source is shared with other threads.
+     */
+    bool open();
+
+    QString errorString() const { return errorString_; }
+    int size() const { return entries_.size(); }
+
+    /**
+     * Returns the number of lines skipped, either because they could not
+     * be read or because they repeat a contact seen earlier in the dump.
+     */
+    int malformedCount() const { return malformedCount_; }
+
+    virtual QVector<ContactListEntry> listEntries(int anchorContactId, int limit);
+    virtual ContactRecord contactDetails(int contactId);
+
+private:
+    struct ContactLine
+    {
+        qint64 offset;
+        int length;
+    };
+    int kindValue(KindLookup lookup, QHash<QString, int> &values, const QString &name);
+    QFile file_;
+    KindLookup kindLookup_;
+    KindLookup subKindLookup_;
+    const uchar *data_;
+    QVector<ContactListEntry> entries_;
+    QHash<int, int> positions_;
+    QHash<int, ContactLine> lines_;
+    QMutex kindMutex_;
+    QHash<QString, int> kinds_;
+    QHash<QString, int> subKinds_;
+    int malformedCount_;
+    QString errorString_;
+};
+
+/**
+ * Opens a dump on the thread it is moved to, since indexing reads through
+ * the whole file.
+ */
+class DumpOpener : public QObject
+{
+    Q_OBJECT
+public:
+    DumpOpener(const QString &fileName, DumpContactSource::KindLookup kindLookup=0,
+        DumpContactSource::KindLookup subKindLookup=0, QObject *parent=0);
+    virtual ~DumpOpener();
+
+    /**
+     * Hands over the opened source once finished, or returns NULL if the
+     * dump could not be opened.
+     */
+    DumpContactSource *takeSource();
+
+    QString errorString() const { return errorString_; }
+public slots:
+    void start();
+signals:
+    void finished(bool success);
+private:
+    DumpContactSource *source_;
+    QString errorString_;
+};
+
+#endif // DUMPCONTACTSOURCE_HPP
@@ -0,0 +1,196 @@
+#include "duplicatedetector.hpp"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QStringList>
+#include <QtCore/QtAlgorithms>
+
+#include "contactsearchindex.hpp"
+
+namespace
+{
+// Phone numbers with fewer digits are extensions or short codes
+const int MinimumPhoneDigits = 7;
+
+// Digits compared from the end of a phone number, so that numbers with
+// and without a country code match
+const int PhoneDigits = 10;
+
+quint64 keyHash(int keyKind, const QString &key)
+{
+    // 64-bit FNV-1a, as collisions between 32-bit hashes would already
+    // merge unrelated contacts in a database of a few ten thousand
+    quint64 hash = Q_UINT64_C(0xcbf29ce484222325);
+    hash = (hash ^ quint64(keyKind)) * Q_UINT64_C(0x100000001b3);
+    const QChar *data = key.constData();
+    for(int i = 0; i < key.length(); i++) {
+        hash = (hash ^ (data[i].unicode() & 0xFF)) * Q_UINT64_C(0x100000001b3);
+        hash = (hash ^ (data[i].unicode() >> 8)) * Q_UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
+
+void writeKey(QDataStream &stream, int contactId, int keyKind, const QString &key)
+{
+    if(key.isEmpty()) { return; }
+    stream << qint32(contactId) << quint8(keyKind) << keyHash(keyKind, key);
+}
+
+bool largerGroup(const DuplicateGroup &group1, const DuplicateGroup &group2)
+{
+    if(group1.contactIds.size() != group2.contactIds.size()) {
+        return group1.contactIds.size() > group2.contactIds.size();
+    }
+    return group1.contactIds.first() < group2.contactIds.first();
+}
+}
+
+DuplicateDetector::DuplicateDetector()
+{
+}
+
+DuplicateDetector::~DuplicateDetector()
+{
+}
+
+QByteArray DuplicateDetector::processPage(const QList<ContactRecord> &contacts)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    foreach(const ContactRecord &contact, contacts) {
+        writeKey(stream, contact.id, NameKey, nameKey(contact.displayName));
+        foreach(const ContactRecordAttribute &attribute, contact.emails) {
+            writeKey(stream, contact.id, EmailKey, emailKey(attribute.value));
+        }
+        foreach(const ContactRecordAttribute &attribute, contact.phoneNumbers) {
+            writeKey(stream, contact.id, PhoneKey, phoneKey(attribute.value));
+        }
+    }
+    return data;
+}
+
+bool DuplicateDetector::consumePage(const QByteArray &result)
+{
+    QDataStream stream(result);
+    while(!stream.atEnd()) {
+        qint32 contactId;
+        quint8 keyKind;
+        quint64 hash;
+        stream >> contactId >> keyKind >> hash;
+
+        QHash<quint64, int>::const_iterator it = keyOwners_.constFind(hash);
+        if(it == keyOwners_.constEnd()) {
+            keyOwners_.insert(hash, contactId);
+        }
+        else if(it.value() != contactId) {
+            unite(it.value(), contactId, keyKind);
+        }
+    }
+    return true;
+}
+
+bool DuplicateDetector::finish(bool success)
+{
+    // Every contact with a duplicate is either a root with matched keys,
+    // or has a parent leading to one.
+    QHash<int, DuplicateGroup> groups;
+    for(QHash<int, int>::const_iterator it = matchedKeys_.constBegin(); it != matchedKeys_.constEnd(); ++it) {
+        DuplicateGroup &group = groups[it.key()];
+        group.contactIds.append(it.key());
+        group.matchedKeys = it.value();
+    }
+    foreach(int contactId, parents_.keys()) {
+        groups[find(contactId)].contactIds.append(contactId);
+    }
+
+    groups_.clear();
+    foreach(DuplicateGroup group, groups) {
+        qSort(group.contactIds);
+        groups_.append(group);
+    }
+    qSort(groups_.begin(), groups_.end(), largerGroup);
+
+    keyOwners_.clear();
+    parents_.clear();
+    matchedKeys_.clear();
+    return success;
+}
+
+QString DuplicateDetector::nameKey(const QString &displayName)
+{
+    // Words are compared regardless of case, accents, punctuation and
+    // order, so that "Smith, John" matches "John Smith".
+    const QString normalized = ContactSearchIndex::normalize(displayName);
+    QStringList words;
+    QString word;
+    for(int i = 0; i <= normalized.length(); i++) {
+        if(i < normalized.length() && normalized[i].isLetterOrNumber()) {
+            word.append(normalized[i]);
+        }
+        else if(!word.isEmpty()) {
+            words.append(word);
+            word.clear();
+        }
+    }
+    qSort(words);
+    return words.join(QLatin1String(" "));
+}
+
+QString DuplicateDetector::emailKey(const QString &email)
+{
+    const QString key = email.trimmed().toLower();
+    if(!key.contains(QLatin1Char('@'))) {
+        return QString();
+    }
+    return key;
+}
+
+QString DuplicateDetector::phoneKey(const QString &phoneNumber)
+{
+    QString digits;
+    digits.reserve(phoneNumber.length());
+    for(int i = 0; i < phoneNumber.length(); i++) {
+        if(phoneNumber[i].isDigit()) {
+            digits.append(phoneNumber[i]);
+        }
+    }
+    if(digits.length() < MinimumPhoneDigits) {
+        return QString();
+    }
+    return digits.right(PhoneDigits);
+}
+
+int DuplicateDetector::find(int contactId)
+{
+    // Only contacts that have been joined to another one have a parent
+    int root = contactId;
+    QHash<int, int>::const_iterator it;
+    while((it = parents_.constFind(root)) != parents_.constEnd()) {
+        root = it.value();
+    }
+
+    // Point the whole path straight at the root for later lookups
+    while(contactId != root) {
+        QHash<int, int>::iterator next = parents_.find(contactId);
+        contactId = next.value();
+        next.value() = root;
+    }
+    return root;
+}
+
+void DuplicateDetector::unite(int contactId1, int contactId2, int keyKind)
+{
+    int root1 = find(contactId1);
+    int root2 = find(contactId2);
+    if(root1 == root2) {
+        matchedKeys_[root1] |= keyKind;
+        return;
+    }
+
+    // The lowest contact ID stays the root, which keeps groups stable
+    if(root2 < root1) {
+        qSwap(root1, root2);
+    }
+    parents_.insert(root2, root1);
+    const int matchedKeys = keyKind | matchedKeys_.take(root2);
+    matchedKeys_[root1] |= matchedKeys;
+}
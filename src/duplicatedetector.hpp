@@ -0,0 +1,66 @@
+#ifndef DUPLICATEDETECTOR_HPP
+#define DUPLICATEDETECTOR_HPP
+
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+#include "contactscanner.hpp"
+
+/**
+ * Contacts that are likely to be duplicates of each other, along with the
+ * kinds of keys that tied them together.
+ */
+struct DuplicateGroup
+{
+    DuplicateGroup() : matchedKeys(0) { }
+    QList<int> contactIds;
+    int matchedKeys;
+};
+
+/**
+ * Scan handler that groups contacts sharing a normalized display name,
+ * email address or phone number.
+ *
+ * Keys are normalized and hashed on the scanner's worker threads. The
+ * pages of hashes are then merged in a single pass, mapping each distinct
+ * key to the first contact seen with it and joining later contacts with
+ * that one in a union-find forest. Memory use is bounded by the number of
+ * distinct keys, plus the contacts that turn out to have duplicates.
+ */
+class DuplicateDetector : public ContactScanHandler
+{
+public:
+    enum KeyKind
+    {
+        NameKey = 0x01,
+        EmailKey = 0x02,
+        PhoneKey = 0x04
+    };
+
+    DuplicateDetector();
+    virtual ~DuplicateDetector();
+    virtual QByteArray processPage(const QList<ContactRecord> &contacts);
+    virtual bool consumePage(const QByteArray &result);
+    virtual bool finish(bool success);
+
+    /**
+     * Returns the groups found by a finished scan, largest first, with
+     * the contact IDs of each group in ascending order.
+     */
+    QList<DuplicateGroup> groups() const { return groups_; }
+
+    static QString nameKey(const QString &displayName);
+    static QString emailKey(const QString &email);
+    static QString phoneKey(const QString &phoneNumber);
+
+private:
+    int find(int contactId);
+    void unite(int contactId1, int contactId2, int keyKind);
+    QHash<quint64, int> keyOwners_;
+    QHash<int, int> parents_;
+    QHash<int, int> matchedKeys_;
+    QList<DuplicateGroup> groups_;
+};
+
+#endif // DUPLICATEDETECTOR_HPP
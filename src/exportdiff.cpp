@@ -0,0 +1,332 @@
+#include "exportdiff.hpp"
+
+#include <cstring>
+
+#include <QtCore/QSet>
+#include <QtCore/QtAlgorithms>
+
+#include "jsonreader.hpp"
+#include "jsonwriter.hpp"
+
+namespace
+{
+quint64 lineHash(const uchar *data, int length)
+{
+    quint64 hash = Q_UINT64_C(0xcbf29ce484222325);
+    for(int i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * Q_UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
+
+int lineContactId(const QByteArray &line, bool *ok)
+{
+    int position = 0;
+    const QVariant contactId = JsonReader::findMember(line, "contactId", &position, ok);
+    if(*ok && contactId.type() == QVariant::LongLong) {
+        return contactId.toInt();
+    }
+
+    const QVariantMap header = JsonReader::parse(line, ok).toMap().value("header").toMap();
+    *ok = *ok && header.contains("contactId");
+    return header.value("contactId").toInt();
+}
+
+/**
+ * Compares lists of objects identified by their "id" member.
+ */
+QVariantMap diffById(const QVariantList &oldList, const QVariantList &newList, int *added, int *removed, int *modified)
+{
+    QHash<qlonglong, QVariant> oldItems;
+    foreach(const QVariant &item, oldList) {
+        oldItems.insert(item.toMap().value("id").toLongLong(), item);
+    }
+
+    QVariantList addedItems;
+    QVariantList modifiedItems;
+    QSet<qlonglong> newIds;
+    foreach(const QVariant &item, newList) {
+        const qlonglong id = item.toMap().value("id").toLongLong();
+        newIds.insert(id);
+        QHash<qlonglong, QVariant>::const_iterator it = oldItems.constFind(id);
+        if(it == oldItems.constEnd()) {
+            addedItems.append(item);
+        }
+        else if(it.value() != item) {
+            QVariantMap change;
+            change["id"] = id;
+            change["new"] = item;
+            change["old"] = it.value();
+            modifiedItems.append(change);
+        }
+    }
+
+    QVariantList removedItems;
+    foreach(const QVariant &item, oldList) {
+        if(!newIds.contains(item.toMap().value("id").toLongLong())) {
+            removedItems.append(item);
+        }
+    }
+
+    *added = addedItems.size();
+    *removed = removedItems.size();
+    *modified = modifiedItems.size();
+
+    QVariantMap result;
+    if(!addedItems.isEmpty()) {
+        result["added"] = addedItems;
+    }
+    if(!modifiedItems.isEmpty()) {
+        result["modified"] = modifiedItems;
+    }
+    if(!removedItems.isEmpty()) {
+        result["removed"] = removedItems;
+    }
+    return result;
+}
+
+QVariantMap diffFields(const QVariantMap &oldMap, const QVariantMap &newMap)
+{
+    QStringList names = oldMap.keys();
+    foreach(const QString &name, newMap.keys()) {
+        if(!oldMap.contains(name)) {
+            names.append(name);
+        }
+    }
+
+    QVariantMap result;
+    foreach(const QString &name, names) {
+        const QVariant oldValue = oldMap.value(name);
+        const QVariant newValue = newMap.value(name);
+        if(oldValue != newValue) {
+            QVariantMap change;
+            change["new"] = newValue;
+            change["old"] = oldValue;
+            result[name] = change;
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns the differences between two versions of a contact, by member,
+ * filling in the summary of the entry.
+ */
+QVariantMap contactChanges(const QVariantMap &oldContact, const QVariantMap &newContact, ExportDiffEntry *entry)
+{
+    QStringList names = oldContact.keys();
+    foreach(const QString &name, newContact.keys()) {
+        if(!oldContact.contains(name)) {
+            names.append(name);
+        }
+    }
+
+    QVariantMap changes;
+    foreach(const QString &name, names) {
+        const QVariant oldValue = oldContact.value(name);
+        const QVariant newValue = newContact.value(name);
+        if(oldValue == newValue) { continue; }
+
+        if(oldValue.type() == QVariant::List || newValue.type() == QVariant::List) {
+            int added = 0;
+            int removed = 0;
+            int modified = 0;
+            changes[name] = diffById(oldValue.toList(), newValue.toList(), &added, &removed, &modified);
+            if(name == QLatin1String("attributes")) {
+                entry->addedAttributes = added;
+                entry->removedAttributes = removed;
+                entry->modifiedAttributes = modified;
+            }
+            else {
+                entry->changedFields.append(name);
+            }
+        }
+        else if(oldValue.type() == QVariant::Map || newValue.type() == QVariant::Map) {
+            const QVariantMap fieldChanges = diffFields(oldValue.toMap(), newValue.toMap());
+            changes[name] = fieldChanges;
+            entry->changedFields.append(fieldChanges.keys());
+        }
+        else {
+            QVariantMap change;
+            change["new"] = newValue;
+            change["old"] = oldValue;
+            changes[name] = change;
+            entry->changedFields.append(name);
+        }
+    }
+    return changes;
+}
+
+QString displayName(const QVariantMap &contact)
+{
+    return contact.value("header").toMap().value("displayName").toString();
+}
+}
+
+ExportDiff::ExportDiff(const QString &oldFileName, const QString &newFileName, const QString &outputFileName, QObject *parent)
+    : QObject(parent), oldFile_(oldFileName), newFile_(newFileName), outputFile_(outputFileName),
+    unchangedCount_(0), malformedCount_(0)
+{
+}
+
+ExportDiff::~ExportDiff()
+{
+}
+
+void ExportDiff::start()
+{
+    emit finished(run());
+}
+
+bool ExportDiff::run()
+{
+    entries_.clear();
+    unchangedCount_ = 0;
+    malformedCount_ = 0;
+
+    if(!oldFile_.open(QIODevice::ReadOnly)) {
+        errorString_ = oldFile_.errorString();
+        return false;
+    }
+    if(!newFile_.open(QIODevice::ReadOnly)) {
+        errorString_ = newFile_.errorString();
+        return false;
+    }
+
+    // The files are mapped rather than read, so that only the index and
+    // the lines being compared take up memory
+    const uchar *oldData = oldFile_.size() > 0 ? oldFile_.map(0, oldFile_.size()) : NULL;
+    const uchar *newData = newFile_.size() > 0 ? newFile_.map(0, newFile_.size()) : NULL;
+    LineIndex oldIndex;
+    LineIndex newIndex;
+    if(!indexFile(oldFile_, oldData, &oldIndex) || !indexFile(newFile_, newData, &newIndex)) {
+        return false;
+    }
+
+    if(!outputFile_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorString_ = outputFile_.errorString();
+        return false;
+    }
+    JsonWriter writer(&outputFile_);
+
+    QList<int> oldIds = oldIndex.keys();
+    qSort(oldIds);
+    foreach(int contactId, oldIds) {
+        const LineInfo &oldLine = oldIndex[contactId];
+        LineIndex::const_iterator it = newIndex.constFind(contactId);
+        if(it != newIndex.constEnd() && it.value().hash == oldLine.hash) {
+            unchangedCount_++;
+            continue;
+        }
+
+        ExportDiffEntry entry;
+        entry.contactId = contactId;
+        const QVariantMap oldContact = readContact(oldData, oldLine);
+        QVariantMap line;
+        if(it == newIndex.constEnd()) {
+            entry.change = ExportDiffEntry::Removed;
+            entry.displayName = displayName(oldContact);
+            line["change"] = QLatin1String("removed");
+            line["contact"] = oldContact;
+        }
+        else {
+            const QVariantMap newContact = readContact(newData, it.value());
+            const QVariantMap changes = contactChanges(oldContact, newContact, &entry);
+            if(changes.isEmpty()) {
+                unchangedCount_++;
+                continue;
+            }
+            entry.change = ExportDiffEntry::Modified;
+            entry.displayName = displayName(newContact);
+            line["change"] = QLatin1String("modified");
+            line["changes"] = changes;
+        }
+        line["contactId"] = contactId;
+        line["displayName"] = entry.displayName;
+        writer.writeVariant(line);
+        writer.endLine();
+        entries_.append(entry);
+    }
+
+    QList<int> newIds = newIndex.keys();
+    qSort(newIds);
+    foreach(int contactId, newIds) {
+        if(oldIndex.contains(contactId)) { continue; }
+
+        ExportDiffEntry entry;
+        entry.contactId = contactId;
+        entry.change = ExportDiffEntry::Added;
+        const QVariantMap newContact = readContact(newData, newIndex[contactId]);
+        entry.displayName = displayName(newContact);
+
+        QVariantMap line;
+        line["change"] = QLatin1String("added");
+        line["contact"] = newContact;
+        line["contactId"] = contactId;
+        line["displayName"] = entry.displayName;
+        writer.writeVariant(line);
+        writer.endLine();
+        entries_.append(entry);
+    }
+
+    const bool success = writer.flush();
+    outputFile_.close();
+    if(!success) {
+        errorString_ = outputFile_.errorString();
+        return false;
+    }
+    outputFile_.setPermissions(
+        QFile::ReadOwner | QFile::WriteOwner |
+        QFile::ReadGroup | QFile::WriteGroup |
+        QFile::ReadOther | QFile::WriteOther);
+    return true;
+}
+
+bool ExportDiff::indexFile(QFile &file, const uchar *data, LineIndex *index)
+{
+    const qint64 size = file.size();
+    if(size > 0 && !data) {
+        errorString_ = file.errorString();
+        return false;
+    }
+
+    qint64 offset = 0;
+    while(offset < size) {
+        const uchar *start = data + offset;
+        const uchar *newline = static_cast<const uchar *>(memchr(start, '\n', size - offset));
+        int length = newline ? int(newline - start) : int(size - offset);
+        const qint64 next = offset + length + 1;
+        if(length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+
+        if(length > 0) {
+            bool ok = false;
+            const int contactId = lineContactId(
+                QByteArray::fromRawData(reinterpret_cast<const char *>(start), length), &ok);
+            if(ok) {
+                LineInfo line;
+                line.offset = offset;
+                line.length = length;
+                line.hash = lineHash(start, length);
+                index->insert(contactId, line);
+            }
+            else {
+                malformedCount_++;
+            }
+        }
+        offset = next;
+    }
+    return true;
+}
+
+QVariantMap ExportDiff::readContact(const uchar *data, const LineInfo &line)
+{
+    bool ok = false;
+    const QVariantMap contact = JsonReader::parse(QByteArray::fromRawData(
+        reinterpret_cast<const char *>(data + line.offset), line.length), &ok).toMap();
+    if(!ok) {
+        malformedCount_++;
+    }
+    return contact;
+}
@@ -0,0 +1,90 @@
+#ifndef EXPORTDIFF_HPP
+#define EXPORTDIFF_HPP
+
+#include <QtCore/QObject>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+
+/**
+ * A contact that differs between two exports.
+ */
+struct ExportDiffEntry
+{
+    enum Change
+    {
+        Added,
+        Removed,
+        Modified
+    };
+
+    ExportDiffEntry() : contactId(0), change(Modified),
+        addedAttributes(0), removedAttributes(0), modifiedAttributes(0) { }
+    int contactId;
+    Change change;
+    QString displayName;
+    QStringList changedFields;
+    int addedAttributes;
+    int removedAttributes;
+    int modifiedAttributes;
+};
+
+/**
+ * Compares two JSON Lines exports of the whole database, as written by
+ * BulkExportHandler.
+ *
+ * Both files are first indexed by contact ID, keeping only the position
+ * and a hash of every line. Since exports write their members in a fixed
+ * order, contacts whose lines hash the same are unchanged, and only the
+ * lines of the remaining contacts are read back and parsed to find which
+ * fields, attributes, photos and source accounts changed. Memory use is
+ * proportional to the number of contacts rather than to the file sizes.
+ *
+ * The full differences are written to an output file as JSON Lines, with
+ * one line per changed contact, while a summary of each change is kept
+ * for display.
+ */
+class ExportDiff : public QObject
+{
+    Q_OBJECT
+public:
+    ExportDiff(const QString &oldFileName, const QString &newFileName, const QString &outputFileName, QObject *parent=0);
+    virtual ~ExportDiff();
+
+    /**
+     * Compares the exports on the calling thread.
+     */
+    bool run();
+
+    const QList<ExportDiffEntry> &entries() const { return entries_; }
+    int unchangedCount() const { return unchangedCount_; }
+    int malformedCount() const { return malformedCount_; }
+    QString errorString() const { return errorString_; }
+public slots:
+    void start();
+signals:
+    void finished(bool success);
+private:
+    struct LineInfo
+    {
+        qint64 offset;
+        int length;
+        quint64 hash;
+    };
+    typedef QHash<int, LineInfo> LineIndex;
+
+    bool indexFile(QFile &file, const uchar *data, LineIndex *index);
+    QVariantMap readContact(const uchar *data, const LineInfo &line);
+
+    QFile oldFile_;
+    QFile newFile_;
+    QFile outputFile_;
+    QList<ExportDiffEntry> entries_;
+    int unchangedCount_;
+    int malformedCount_;
+    QString errorString_;
+};
+
+#endif // EXPORTDIFF_HPP
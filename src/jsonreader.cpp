@@ -0,0 +1,281 @@
+#include "jsonreader.hpp"
+
+#include <QtCore/QVariantMap>
+#include <QtCore/QVariantList>
+
+namespace
+{
+// Nesting deeper than this is treated as malformed, rather than risking
+// running out of stack on hostile input
+const int MaximumDepth = 64;
+}
+
+JsonReader::JsonReader(const char *begin, const char *end)
+    : pos_(begin), end_(end), depth_(0), error_(false)
+{
+}
+
+QVariant JsonReader::parse(const QByteArray &data, bool *ok)
+{
+    JsonReader reader(data.constData(), data.constData() + data.size());
+    QVariant value = reader.parseValue();
+    reader.skipWhitespace();
+    const bool valid = !reader.error_ && reader.pos_ == reader.end_;
+    if(ok) {
+        *ok = valid;
+    }
+    return valid ? value : QVariant();
+}
+
+QVariant JsonReader::findMember(const QByteArray &data, const char *name, int *position, bool *ok)
+{
+    // Quotes within strings are always escaped, so the quoted name
+    // followed by a colon can only match a member name
+    QByteArray key;
+    key.reserve(qstrlen(name) + 3);
+    key.append('"');
+    key.append(name);
+    key.append("\":");
+
+    const int index = data.indexOf(key, *position);
+    if(index < 0) {
+        if(ok) {
+            *ok = false;
+        }
+        return QVariant();
+    }
+
+    JsonReader reader(data.constData() + index + key.size(), data.constData() + data.size());
+    const QVariant value = reader.parseValue();
+    *position = int(reader.pos_ - data.constData());
+    if(ok) {
+        *ok = !reader.error_;
+    }
+    return reader.error_ ? QVariant() : value;
+}
+
+QVariant JsonReader::parseValue()
+{
+    skipWhitespace();
+    if(pos_ >= end_) {
+        error_ = true;
+        return QVariant();
+    }
+
+    switch(*pos_) {
+    case '{':
+    case '[':
+    {
+        if(++depth_ > MaximumDepth) {
+            error_ = true;
+            return QVariant();
+        }
+        const QVariant value = (*pos_ == '{') ? parseObject() : parseArray();
+        depth_--;
+        return value;
+    }
+    case '"':
+        return parseString();
+    case 't':
+        return expect("true") ? QVariant(true) : QVariant();
+    case 'f':
+        return expect("false") ? QVariant(false) : QVariant();
+    case 'n':
+        expect("null");
+        return QVariant();
+    default:
+        return parseNumber();
+    }
+}
+
+QVariant JsonReader::parseObject()
+{
+    QVariantMap map;
+    pos_++;
+    skipWhitespace();
+    if(pos_ < end_ && *pos_ == '}') {
+        pos_++;
+        return map;
+    }
+
+    while(!error_) {
+        skipWhitespace();
+        if(pos_ >= end_ || *pos_ != '"') {
+            error_ = true;
+            break;
+        }
+        const QString name = parseString();
+        skipWhitespace();
+        if(pos_ >= end_ || *pos_ != ':') {
+            error_ = true;
+            break;
+        }
+        pos_++;
+        map.insert(name, parseValue());
+
+        skipWhitespace();
+        if(pos_ < end_ && *pos_ == ',') {
+            pos_++;
+        }
+        else if(pos_ < end_ && *pos_ == '}') {
+            pos_++;
+            break;
+        }
+        else {
+            error_ = true;
+        }
+    }
+    return map;
+}
+
+QVariant JsonReader::parseArray()
+{
+    QVariantList list;
+    pos_++;
+    skipWhitespace();
+    if(pos_ < end_ && *pos_ == ']') {
+        pos_++;
+        return list;
+    }
+
+    while(!error_) {
+        list.append(parseValue());
+        skipWhitespace();
+        if(pos_ < end_ && *pos_ == ',') {
+            pos_++;
+        }
+        else if(pos_ < end_ && *pos_ == ']') {
+            pos_++;
+            break;
+        }
+        else {
+            error_ = true;
+        }
+    }
+    return list;
+}
+
+QVariant JsonReader::parseNumber()
+{
+    const char *start = pos_;
+    bool integer = true;
+    if(pos_ < end_ && *pos_ == '-') {
+        pos_++;
+    }
+    while(pos_ < end_) {
+        const char c = *pos_;
+        if(c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+            integer = false;
+        }
+        else if(c < '0' || c > '9') {
+            break;
+        }
+        pos_++;
+    }
+
+    bool ok = false;
+    const QByteArray text = QByteArray::fromRawData(start, pos_ - start);
+    if(integer) {
+        const qlonglong value = text.toLongLong(&ok);
+        if(ok) {
+            return value;
+        }
+    }
+    const double value = text.toDouble(&ok);
+    if(!ok) {
+        error_ = true;
+        return QVariant();
+    }
+    return value;
+}
+
+QString JsonReader::parseString()
+{
+    pos_++;
+    const char *start = pos_;
+
+    // Strings without escapes are converted in one go
+    while(pos_ < end_ && *pos_ != '"' && *pos_ != '\\') {
+        pos_++;
+    }
+    if(pos_ < end_ && *pos_ == '"') {
+        pos_++;
+        return QString::fromUtf8(start, pos_ - start - 1);
+    }
+
+    QByteArray utf8(start, pos_ - start);
+    while(pos_ < end_ && *pos_ != '"') {
+        if(*pos_ != '\\') {
+            utf8.append(*pos_++);
+            continue;
+        }
+
+        pos_++;
+        if(pos_ >= end_) { break; }
+        const char c = *pos_++;
+        switch(c) {
+        case 'b': utf8.append('\b'); break;
+        case 'f': utf8.append('\f'); break;
+        case 'n': utf8.append('\n'); break;
+        case 'r': utf8.append('\r'); break;
+        case 't': utf8.append('\t'); break;
+        case 'u':
+        {
+            uint code = 0;
+            if(!parseHex(&code)) { return QString(); }
+            QString chars(QChar(ushort(code)));
+            if(QChar(ushort(code)).isHighSurrogate() && end_ - pos_ >= 6 && pos_[0] == '\\' && pos_[1] == 'u') {
+                pos_ += 2;
+                uint low = 0;
+                if(!parseHex(&low)) { return QString(); }
+                chars.append(QChar(ushort(low)));
+            }
+            utf8.append(chars.toUtf8());
+            break;
+        }
+        default:
+            utf8.append(c);
+            break;
+        }
+    }
+
+    if(pos_ >= end_) {
+        error_ = true;
+        return QString();
+    }
+    pos_++;
+    return QString::fromUtf8(utf8.constData(), utf8.size());
+}
+
+bool JsonReader::parseHex(uint *value)
+{
+    if(end_ - pos_ < 4) {
+        error_ = true;
+        return false;
+    }
+    bool ok = false;
+    *value = QByteArray::fromRawData(pos_, 4).toUInt(&ok, 16);
+    pos_ += 4;
+    if(!ok) {
+        error_ = true;
+    }
+    return ok;
+}
+
+bool JsonReader::expect(const char *literal)
+{
+    const int length = qstrlen(literal);
+    if(end_ - pos_ < length || qstrncmp(pos_, literal, length) != 0) {
+        error_ = true;
+        return false;
+    }
+    pos_ += length;
+    return true;
+}
+
+void JsonReader::skipWhitespace()
+{
+    while(pos_ < end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r')) {
+        pos_++;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef JSONREADER_HPP
+#define JSONREADER_HPP
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+
+/**
+ * Parser for single JSON documents, such as one line of a JSON Lines
+ * file, into variants.
+ *
+ * Objects become QVariantMap, arrays QVariantList, integers qlonglong and
+ * other numbers double, matching what JsonWriter::writeVariant() accepts.
+ */
+class JsonReader
+{
+public:
+    /**
+     * Parses a complete document, returning an invalid variant and
+     * clearing ok if it is malformed.
+     */
+    static QVariant parse(const QByteArray &data, bool *ok=0);
+
+    /**
+     * Returns the value of the first member with the given name, at or
+     * after position, moving position past the value. Only the value is
+     * parsed, so this finds header fields in a line of an export without
+     * reading the whole contact. Documents must be written without
+     * whitespace between names and values, as JsonWriter does.
+     */
+    static QVariant findMember(const QByteArray &data, const char *name, int *position, bool *ok=0);
+
+private:
+    JsonReader(const char *begin, const char *end);
+    QVariant parseValue();
+    QVariant parseObject();
+    QVariant parseArray();
+    QVariant parseNumber();
+    QString parseString();
+    bool parseHex(uint *value);
+    bool expect(const char *literal);
+    void skipWhitespace();
+
+    const char *pos_;
+    const char *end_;
+    int depth_;
+    bool error_;
+};
+
+#endif // JSONREADER_HPP
@@ -0,0 +1,245 @@
+#include "jsonwriter.hpp"
+
+#include <QtCore/QIODevice>
+#include <QtCore/QStringList>
+#include <QtCore/QVariantMap>
+
+namespace
+{
+const int BufferSize = 16384;
+const int IndentWidth = 4;
+}
+
+JsonWriter::JsonWriter(QIODevice *device, bool indented)
+    : device_(device), indented_(indented), afterName_(false), error_(false)
+{
+    buffer_.reserve(BufferSize);
+}
+
+JsonWriter::~JsonWriter()
+{
+    flush();
+}
+
+void JsonWriter::beginObject()
+{
+    beforeValue();
+    append('{');
+    counts_.append(0);
+}
+
+void JsonWriter::endObject()
+{
+    const int count = counts_.last();
+    counts_.pop_back();
+    if(count > 0) {
+        writeIndent();
+    }
+    append('}');
+}
+
+void JsonWriter::beginArray()
+{
+    beforeValue();
+    append('[');
+    counts_.append(0);
+}
+
+void JsonWriter::endArray()
+{
+    const int count = counts_.last();
+    counts_.pop_back();
+    if(count > 0) {
+        writeIndent();
+    }
+    append(']');
+}
+
+void JsonWriter::writeName(const QString &name)
+{
+    beforeValue();
+    appendString(name);
+    append(':');
+    if(indented_) {
+        append(' ');
+    }
+    afterName_ = true;
+}
+
+void JsonWriter::writeString(const QString &value)
+{
+    beforeValue();
+    appendString(value);
+}
+
+void JsonWriter::writeNumber(qint64 value)
+{
+    beforeValue();
+    append(QByteArray::number(value));
+}
+
+void JsonWriter::writeDouble(double value)
+{
+    beforeValue();
+    append(QByteArray::number(value, 'g', 15));
+}
+
+void JsonWriter::writeBool(bool value)
+{
+    beforeValue();
+    append(value ? QByteArray("true") : QByteArray("false"));
+}
+
+void JsonWriter::writeNull()
+{
+    beforeValue();
+    append(QByteArray("null"));
+}
+
+void JsonWriter::writeVariant(const QVariant &value)
+{
+    switch(value.type()) {
+    case QVariant::Invalid:
+        writeNull();
+        break;
+    case QVariant::Bool:
+        writeBool(value.toBool());
+        break;
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        writeNumber(value.toLongLong());
+        break;
+    case QVariant::Double:
+        writeDouble(value.toDouble());
+        break;
+    case QVariant::Map:
+    {
+        const QVariantMap map = value.toMap();
+        beginObject();
+        for(QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+            writeName(it.key());
+            writeVariant(it.value());
+        }
+        endObject();
+        break;
+    }
+    case QVariant::List:
+    case QVariant::StringList:
+    {
+        const QVariantList list = value.toList();
+        beginArray();
+        foreach(const QVariant &item, list) {
+            writeVariant(item);
+        }
+        endArray();
+        break;
+    }
+    default:
+        writeString(value.toString());
+        break;
+    }
+}
+
+void JsonWriter::endLine()
+{
+    append('\n');
+}
+
+bool JsonWriter::flush()
+{
+    if(!buffer_.isEmpty()) {
+        if(device_->write(buffer_) != buffer_.size()) {
+            error_ = true;
+        }
+        buffer_.clear();
+    }
+    return !error_;
+}
+
+void JsonWriter::beforeValue()
+{
+    if(afterName_) {
+        afterName_ = false;
+        return;
+    }
+    if(!counts_.isEmpty()) {
+        if(counts_.last() > 0) {
+            append(',');
+        }
+        counts_.last()++;
+        writeIndent();
+    }
+}
+
+void JsonWriter::writeIndent()
+{
+    if(!indented_) { return; }
+    append('\n');
+    append(QByteArray(counts_.size() * IndentWidth, ' '));
+}
+
+void JsonWriter::appendString(const QString &value)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    const QByteArray utf8 = value.toUtf8();
+    QByteArray escaped;
+    escaped.reserve(utf8.size() + 2);
+    escaped.append('"');
+    for(int i = 0; i < utf8.size(); i++) {
+        const unsigned char c = utf8[i];
+        switch(c) {
+        case '"':
+            escaped.append("\\\"");
+            break;
+        case '\\':
+            escaped.append("\\\\");
+            break;
+        case '\b':
+            escaped.append("\\b");
+            break;
+        case '\f':
+            escaped.append("\\f");
+            break;
+        case '\n':
+            escaped.append("\\n");
+            break;
+        case '\r':
+            escaped.append("\\r");
+            break;
+        case '\t':
+            escaped.append("\\t");
+            break;
+        default:
+            if(c < 0x20) {
+                escaped.append("\\u00");
+                escaped.append(hexDigits[c >> 4]);
+                escaped.append(hexDigits[c & 0x0F]);
+            }
+            else {
+                escaped.append(char(c));
+            }
+            break;
+        }
+    }
+    escaped.append('"');
+    append(escaped);
+}
+
+void JsonWriter::append(const QByteArray &data)
+{
+    buffer_.append(data);
+    if(buffer_.size() >= BufferSize) {
+        flush();
+    }
+}
+
+void JsonWriter::append(char c)
+{
+    buffer_.append(c);
+    if(buffer_.size() >= BufferSize) {
+        flush();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef JSONWRITER_HPP
+#define JSONWRITER_HPP
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QVariant>
+
+class QIODevice;
+
+/**
+ * Streaming JSON writer.
+ *
+ * Output is collected in a small buffer and written to the device as it
+ * fills up, so documents of any size can be produced without holding
+ * them in memory. Object members are written with writeName() followed
+ * by the value.
+ */
+class JsonWriter
+{
+public:
+    explicit JsonWriter(QIODevice *device, bool indented=false);
+    ~JsonWriter();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void writeName(const QString &name);
+
+    void writeString(const QString &value);
+    void writeNumber(qint64 value);
+    void writeDouble(double value);
+    void writeBool(bool value);
+    void writeNull();
+    void writeVariant(const QVariant &value);
+
+    /**
+     * Ends a top-level value with a line break, for writing one document
+     * per line.
+     */
+    void endLine();
+
+    bool flush();
+    bool hasError() const { return error_; }
+
+private:
+    void beforeValue();
+    void writeIndent();
+    void appendString(const QString &value);
+    void append(const QByteArray &data);
+    void append(char c);
+
+    QIODevice *device_;
+    bool indented_;
+    QByteArray buffer_;
+    QVector<int> counts_;
+    bool afterName_;
+    bool error_;
+};
+
+#endif // JSONWRITER_HPP
@@ -0,0 +1,143 @@
+#include "photocache.hpp"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtGui/QImage>
+#include <QtGui/QImageReader>
+
+#include <bb/ImageData>
+#include <bb/PixelFormat>
+
+namespace
+{
+// Largest dimension of a decoded photo, matching the list item image
+const int ThumbnailSize = 128;
+
+// Total size of the decoded pixels kept in the cache
+const int CacheBytes = 8 * 1024 * 1024;
+
+// Older requests beyond this many are dropped while the list is scrolled
+const int MaximumQueuedRequests = 48;
+
+class PhotoDecodeTask : public QRunnable
+{
+public:
+    PhotoDecodeTask(PhotoCache *cache, const QString &filePath)
+        : cache_(cache), filePath_(filePath) { }
+    void run()
+    {
+        // Letting the reader scale while decoding avoids producing the
+        // full size image first, where the format supports it.
+        QImageReader reader(filePath_);
+        const QSize size = reader.size();
+        if(size.isValid() && (size.width() > ThumbnailSize || size.height() > ThumbnailSize)) {
+            reader.setScaledSize(size.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio));
+        }
+
+        QImage image = reader.read();
+        if(!image.isNull()) {
+            if(image.width() > ThumbnailSize || image.height() > ThumbnailSize) {
+                image = image.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            }
+            // Swapping red and blue turns the native ARGB words into the
+            // RGBA byte order expected by ImageData.
+            image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied).rgbSwapped();
+        }
+
+        QMetaObject::invokeMethod(cache_, "onImageDecoded", Qt::QueuedConnection,
+            Q_ARG(QString, filePath_), Q_ARG(QImage, image));
+    }
+private:
+    PhotoCache *cache_;
+    QString filePath_;
+};
+}
+
+PhotoCache *PhotoCache::instance_ = NULL;
+
+PhotoCache::PhotoCache(QObject *parent) : QObject(parent),
+    images_(CacheBytes), decoding_(0)
+{
+    Q_ASSERT(!instance_);
+    instance_ = this;
+    decodePool_.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+PhotoCache::~PhotoCache()
+{
+    queue_.clear();
+    decodePool_.waitForDone();
+    instance_ = NULL;
+}
+
+PhotoCache *PhotoCache::instance()
+{
+    return instance_;
+}
+
+bb::cascades::Image PhotoCache::image(const QString &filePath)
+{
+    if(filePath.isEmpty()) { return bb::cascades::Image(); }
+
+    bb::cascades::Image *image = images_.object(filePath);
+    if(image) {
+        return *image;
+    }
+    request(filePath);
+    return bb::cascades::Image();
+}
+
+void PhotoCache::prefetch(const QStringList &filePaths)
+{
+    foreach(const QString &filePath, filePaths) {
+        if(!filePath.isEmpty() && !images_.contains(filePath)) {
+            request(filePath);
+        }
+    }
+}
+
+void PhotoCache::request(const QString &filePath)
+{
+    if(pending_.contains(filePath)) {
+        // Move a queued request to the front of the line
+        if(queue_.removeOne(filePath)) {
+            queue_.append(filePath);
+        }
+        return;
+    }
+
+    pending_.insert(filePath);
+    queue_.append(filePath);
+    while(queue_.size() > MaximumQueuedRequests) {
+        pending_.remove(queue_.takeFirst());
+    }
+    startDecodes();
+}
+
+void PhotoCache::startDecodes()
+{
+    while(!queue_.isEmpty() && decoding_ < decodePool_.maxThreadCount()) {
+        decodePool_.start(new PhotoDecodeTask(this, queue_.takeLast()));
+        decoding_++;
+    }
+}
+
+void PhotoCache::onImageDecoded(const QString &filePath, const QImage &image)
+{
+    decoding_--;
+    pending_.remove(filePath);
+
+    // Photos that fail to decode are cached as null images, so they are
+    // not requested over and over again.
+    bb::cascades::Image *cached = new bb::cascades::Image();
+    int cost = 1;
+    if(!image.isNull()) {
+        *cached = bb::cascades::Image(bb::ImageData::fromPixels(image.constBits(),
+            bb::PixelFormat::RGBA_Premultiplied, image.width(), image.height(), image.bytesPerLine()));
+        cost = image.byteCount();
+    }
+    images_.insert(filePath, cached, cost);
+
+    emit imageReady(filePath);
+    startDecodes();
+}
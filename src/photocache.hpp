@@ -0,0 +1,65 @@
+#ifndef PHOTOCACHE_HPP
+#define PHOTOCACHE_HPP
+
+#include <QtCore/QObject>
+#include <QtCore/QCache>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
+
+#include <bb/cascades/Image>
+
+class QImage;
+
+/**
+ * Application-wide cache of decoded contact photo thumbnails.
+ *
+ * Photos are decoded and scaled down on a pool of worker threads, and kept
+ * in a least recently used cache limited by the memory their pixels take.
+ * Requests waiting to be decoded are served most recent first, so that
+ * while the list is scrolled quickly the rows currently on screen are not
+ * stuck behind the ones already scrolled past.
+ *
+ * The cache must only be used from the UI thread.
+ */
+class PhotoCache : public QObject
+{
+    Q_OBJECT
+public:
+    PhotoCache(QObject *parent=0);
+    virtual ~PhotoCache();
+
+    static PhotoCache *instance();
+
+    /**
+     * Returns the decoded photo, or a null image if it is not available
+     * yet, in which case it is queued for decoding and imageReady() is
+     * emitted once it is.
+     */
+    bb::cascades::Image image(const QString &filePath);
+
+    /**
+     * Queues photos for decoding ahead of being asked for.
+     */
+    void prefetch(const QStringList &filePaths);
+
+signals:
+    void imageReady(const QString &filePath);
+
+private slots:
+    void onImageDecoded(const QString &filePath, const QImage &image);
+
+private:
+    void request(const QString &filePath);
+    void startDecodes();
+    static PhotoCache *instance_;
+    QThreadPool decodePool_;
+    QCache<QString, bb::cascades::Image> images_;
+    QList<QString> queue_;
+    QSet<QString> pending_;
+    int decoding_;
+};
+
+#endif // PHOTOCACHE_HPP
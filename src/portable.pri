@@ -0,0 +1,42 @@
+# Sources depending only on QtCore, shared with the tools that are built
+# and run on the desktop.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += $$PWD/binaryexport.cpp \
+    $$PWD/contactdetails.cpp \
+    $$PWD/contactexporter.cpp \
+    $$PWD/contactlistsnapshot.cpp \
+    $$PWD/contactscanner.cpp \
+    $$PWD/contactsearchindex.cpp \
+    $$PWD/contactsloader.cpp \
+    $$PWD/contactstatistics.cpp \
+    $$PWD/detailscache.cpp \
+    $$PWD/dumpcontactsource.cpp \
+    $$PWD/duplicatedetector.cpp \
+    $$PWD/exportdiff.cpp \
+    $$PWD/jsonreader.cpp \
+    $$PWD/jsonwriter.cpp \
+    $$PWD/syntheticcontactsource.cpp \
+    $$PWD/trace.cpp
+
+HEADERS += $$PWD/binaryexport.hpp \
+    $$PWD/contactdetails.hpp \
+    $$PWD/contactexporter.hpp \
+    $$PWD/contactlistentry.hpp \
+    $$PWD/contactlistsnapshot.hpp \
+    $$PWD/contactrecord.hpp \
+    $$PWD/contactscanner.hpp \
+    $$PWD/contactsearchindex.hpp \
+    $$PWD/contactsloader.hpp \
+    $$PWD/contactsource.hpp \
+    $$PWD/contactstatistics.hpp \
+    $$PWD/detailscache.hpp \
+    $$PWD/dumpcontactsource.hpp \
+    $$PWD/duplicatedetector.hpp \
+    $$PWD/exportdiff.hpp \
+    $$PWD/jsonreader.hpp \
+    $$PWD/jsonwriter.hpp \
+    $$PWD/syntheticcontactsource.hpp \
+    $$PWD/trace.hpp
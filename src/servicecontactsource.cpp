@@ -0,0 +1,229 @@
+#include "servicecontactsource.hpp"
+
+#include <QtCore/QThreadStorage>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QtAlgorithms>
+
+#include <bb/pim/contacts/ContactService>
+#include <bb/pim/contacts/ContactListFilters>
+#include <bb/pim/contacts/ContactAttribute>
+#include <bb/pim/contacts/ContactPhoto>
+#include <bb/pim/contacts/ContactPostalAddress>
+
+#include "accountcache.hpp"
+#include "attributenames.hpp"
+
+namespace
+{
+// Contacts requested at a time when reading a whole partition
+const int PartitionReadSize = 500;
+
+QThreadStorage<bb::pim::contacts::ContactService *> threadContactService;
+
+bb::pim::contacts::ContactService *contactService()
+{
+    if(!threadContactService.hasLocalData()) {
+        threadContactService.setLocalData(new bb::pim::contacts::ContactService());
+    }
+    return threadContactService.localData();
+}
+
+bb::pim::contacts::ContactListFilters listFilters(int anchorContactId, int limit)
+{
+    bb::pim::contacts::ContactListFilters options;
+    options.setLimit(limit);
+    options.setSortBy(bb::pim::contacts::SortColumn::FirstName, bb::pim::contacts::SortOrder::Ascending);
+    if(anchorContactId != 0) {
+        options.setAnchorId(anchorContactId);
+    }
+    return options;
+}
+
+QVector<ContactListEntry> serviceListEntries(bb::pim::contacts::ContactListFilters options, int limit)
+{
+    // Invalid contacts are skipped, and the page is filled up from after
+    // the last contact returned, so that only the end of the list makes
+    // for a short page, and only valid contacts become anchors.
+    QVector<ContactListEntry> entries;
+    entries.reserve(limit);
+    int anchorContactId = 0;
+    while(entries.size() < limit) {
+        const int requested = limit - entries.size();
+        options.setLimit(requested);
+        const QList<bb::pim::contacts::Contact> contacts = contactService()->contacts(options);
+        int lastContactId = 0;
+        foreach(const bb::pim::contacts::Contact &contact, contacts) {
+            if(contact.id() != 0) {
+                lastContactId = contact.id();
+            }
+            if(!contact.isValid()) { continue; }
+            ContactListEntry entry;
+            entry.contactId = contact.id();
+            entry.displayName = contact.displayName();
+            entry.displayCompanyName = contact.displayCompanyName();
+            entry.photoFilepath = contact.smallPhotoFilepath();
+            entries.append(entry);
+        }
+        if(contacts.size() < requested || lastContactId == 0 || lastContactId == anchorContactId) {
+            break;
+        }
+        anchorContactId = lastContactId;
+        options.setAnchorId(anchorContactId);
+    }
+    return entries;
+}
+
+ContactRecordAttribute attributeRecord(const bb::pim::contacts::ContactAttribute &attribute)
+{
+    ContactRecordAttribute record;
+    record.id = attribute.id();
+    record.kind = attribute.kind();
+    record.subKind = attribute.subKind();
+    record.kindName = AttributeNames::kindName(attribute.kind());
+    record.subKindName = AttributeNames::subKindName(attribute.subKind());
+    record.label = attribute.attributeDisplayLabel();
+    record.value = attribute.value();
+    foreach(int source, attribute.sources()) {
+        record.sources.append(source);
+    }
+    return record;
+}
+}
+
+ServiceContactSource::ServiceContactSource()
+{
+}
+
+ServiceContactSource::~ServiceContactSource()
+{
+}
+
+QVector<ContactListEntry> ServiceContactSource::listEntries(int anchorContactId, int limit)
+{
+    return serviceListEntries(listFilters(anchorContactId, limit), limit);
+}
+
+QList<int> ServiceContactSource::partitions()
+{
+    // Contacts stored only on the device belong to its local account, so
+    // the contact accounts cover every contact.
+    QList<int> accountIds;
+    foreach(const AccountInfo &account, AccountCache::instance()->contactAccounts()) {
+        accountIds.append(account.id);
+    }
+    return accountIds;
+}
+
+QVector<ContactListEntry> ServiceContactSource::listPartitionEntries(int partition, int anchorContactId, int limit)
+{
+    if(anchorContactId == 0) {
+        SortedPartition sorted;
+        int anchor = 0;
+        bool more = true;
+        while(more) {
+            bb::pim::contacts::ContactListFilters options = listFilters(anchor, PartitionReadSize);
+            options.setIncludeAccounts(QList<bb::pim::contacts::AccountId>() << partition);
+            const QVector<ContactListEntry> entries = serviceListEntries(options, PartitionReadSize);
+            sorted.entries += entries;
+            more = entries.size() == PartitionReadSize;
+            if(more) {
+                anchor = entries.last().contactId;
+            }
+        }
+        qSort(sorted.entries.begin(), sorted.entries.end(), entryLessThan);
+
+        QMutexLocker locker(&partitionMutex_);
+        sortedPartitions_.insert(partition, sorted);
+    }
+
+    QMutexLocker locker(&partitionMutex_);
+    QHash<int, SortedPartition>::iterator it = sortedPartitions_.find(partition);
+    if(it == sortedPartitions_.end()) {
+        return QVector<ContactListEntry>();
+    }
+
+    // Pages are asked for in turn, so the anchor is normally the last
+    // entry handed out
+    SortedPartition &sorted = it.value();
+    if(anchorContactId != 0 && (sorted.position == 0
+        || sorted.entries[sorted.position - 1].contactId != anchorContactId)) {
+        sorted.position = sorted.entries.size();
+        for(int i = 0; i < sorted.entries.size(); i++) {
+            if(sorted.entries[i].contactId == anchorContactId) {
+                sorted.position = i + 1;
+                break;
+            }
+        }
+    }
+
+    const int count = qMax(0, qMin(limit, sorted.entries.size() - sorted.position));
+    const QVector<ContactListEntry> page = sorted.entries.mid(sorted.position, count);
+    sorted.position += page.size();
+    if(page.size() < limit) {
+        sortedPartitions_.erase(it);
+    }
+    return page;
+}
+
+ContactRecord ServiceContactSource::contactDetails(int contactId)
+{
+    const bb::pim::contacts::Contact contact = contactService()->contactDetails(contactId);
+    if(!contact.isValid()) {
+        return ContactRecord();
+    }
+    return record(contact);
+}
+
+ContactRecord ServiceContactSource::record(const bb::pim::contacts::Contact &contact)
+{
+    ContactRecord record;
+    record.id = contact.id();
+    record.accountId = contact.accountId();
+    record.displayName = contact.displayName();
+    record.displayCompanyName = contact.displayCompanyName();
+    record.firstName = contact.firstName();
+    record.lastName = contact.lastName();
+    record.smallPhotoFilepath = contact.smallPhotoFilepath();
+    record.primaryPhotoId = contact.primaryPhoto().id();
+
+    AccountCache *accountCache = AccountCache::instance();
+    foreach(const bb::pim::contacts::AccountId accountId, contact.sourceAccountIds()) {
+        const AccountInfo info = accountCache->account(accountId);
+        ContactRecordAccount account;
+        account.id = accountId;
+        account.displayName = info.displayName;
+        account.providerId = info.providerId;
+        account.providerName = info.providerName;
+        record.sourceAccounts.append(account);
+    }
+
+    foreach(const bb::pim::contacts::ContactAttribute &attribute, contact.attributes()) {
+        record.attributes.append(attributeRecord(attribute));
+    }
+    foreach(const bb::pim::contacts::ContactAttribute &attribute, contact.emails()) {
+        record.emails.append(attributeRecord(attribute));
+    }
+    foreach(const bb::pim::contacts::ContactAttribute &attribute, contact.phoneNumbers()) {
+        record.phoneNumbers.append(attributeRecord(attribute));
+    }
+
+    foreach(const bb::pim::contacts::ContactPhoto &photo, contact.photos()) {
+        ContactRecordPhoto photoRecord;
+        photoRecord.id = photo.id();
+        photoRecord.sourceAccountId = photo.sourceAccountId();
+        photoRecord.smallPhotoFilepath = photo.smallPhoto();
+        record.photos.append(photoRecord);
+    }
+
+    foreach(const bb::pim::contacts::ContactPostalAddress &address, contact.postalAddresses()) {
+        ContactRecordAddress addressRecord;
+        addressRecord.label = address.label();
+        addressRecord.line1 = address.line1();
+        addressRecord.line2 = address.line2();
+        addressRecord.city = address.city();
+        addressRecord.region = address.region();
+        addressRecord.country = address.country();
+        record.postalAddresses.append(addressRecord);
+    }
+    return record;
+}
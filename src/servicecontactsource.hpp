@@ -0,0 +1,46 @@
+#ifndef SERVICECONTACTSOURCE_HPP
+#define SERVICECONTACTSOURCE_HPP
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+
+#include <bb/pim/contacts/Contact>
+
+#include "contactsource.hpp"
+
+/**
+ * Contact source reading from the device contact service, through a
+ * service instance belonging to the calling thread.
+ *
+ * Contacts are partitioned by the accounts they come from, with contacts
+ * that are merged from several accounts appearing in each of them.
+ *
+ * The service can only sort by first name, so each partition is read in
+ * full when its first page is asked for, sorted in list order, and then
+ * handed out a page at a time, letting the loader merge partitions.
+ */
+class ServiceContactSource : public ContactSource
+{
+public:
+    ServiceContactSource();
+    virtual ~ServiceContactSource();
+
+    virtual QVector<ContactListEntry> listEntries(int anchorContactId, int limit);
+    virtual QList<int> partitions();
+    virtual QVector<ContactListEntry> listPartitionEntries(int partition, int anchorContactId, int limit);
+    virtual ContactRecord contactDetails(int contactId);
+
+    static ContactRecord record(const bb::pim::contacts::Contact &contact);
+
+private:
+    struct SortedPartition
+    {
+        SortedPartition() : position(0) { }
+        QVector<ContactListEntry> entries;
+        int position;
+    };
+    QMutex partitionMutex_;
+    QHash<int, SortedPartition> sortedPartitions_;
+};
+
+#endif // SERVICECONTACTSOURCE_HPP
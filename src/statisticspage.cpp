@@ -0,0 +1,195 @@
+#include "statisticspage.hpp"
+
+#include <QtCore/QFile>
+#include <QtCore/QPair>
+#include <QtCore/QUrl>
+#include <QtCore/QtAlgorithms>
+
+#include <bb/cascades/QmlDocument>
+#include <bb/cascades/Page>
+#include <bb/cascades/NavigationPane>
+#include <bb/cascades/ListView>
+#include <bb/cascades/GroupDataModel>
+#include <bb/cascades/ActionItem>
+#include <bb/cascades/pickers/FilePicker>
+#include <bb/system/SystemToast>
+
+#include "jsonwriter.hpp"
+
+using namespace bb::cascades;
+
+namespace
+{
+typedef QPair<QString, qint64> NamedCount;
+
+bool largerCount(const NamedCount &count1, const NamedCount &count2)
+{
+    if(count1.second != count2.second) {
+        return count1.second > count2.second;
+    }
+    return count1.first < count2.first;
+}
+
+QList<NamedCount> sortedCounts(const QHash<QString, qint64> &counts)
+{
+    QList<NamedCount> result;
+    for(QHash<QString, qint64>::const_iterator it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        result.append(qMakePair(it.key(), it.value()));
+    }
+    qSort(result.begin(), result.end(), largerCount);
+    return result;
+}
+
+QVariantMap reportItem(const QString &group, int rank, const QString &title, const QString &description, const QVariant &status)
+{
+    QVariantMap map;
+    map["group"] = group;
+    map["rank"] = rank;
+    map["title"] = title;
+    map["description"] = description;
+    map["status"] = status;
+    return map;
+}
+}
+
+StatisticsPage::StatisticsPage(const ContactStatistics &statistics, QObject *parent)
+    : QObject(parent), statistics_(statistics)
+{
+    QmlDocument *qml = QmlDocument::create("asset:///ReportPage.qml").parent(this);
+    page_ = qml->createRootObject<Page>();
+    connect(page_, SIGNAL(openContact(int)), this, SIGNAL(openContact(int)));
+    connect(page_, SIGNAL(destroyed()), this, SLOT(deleteLater()));
+    page_->setProperty("reportTitle", tr("Statistics"));
+    page_->setProperty("summary",
+        tr("%1 contacts with %2 attributes and %3 postal addresses, "
+            "%4 photos on %5 contacts, about %6 KB of details")
+        .arg(statistics_.contactCount)
+        .arg(statistics_.attributeCount)
+        .arg(statistics_.postalAddressCount)
+        .arg(statistics_.photoCount)
+        .arg(statistics_.contactsWithPhotos)
+        .arg(statistics_.byteSize / 1024));
+
+    GroupDataModel *reportModel = new GroupDataModel(QStringList() << "group" << "rank", this);
+    reportModel->setGrouping(ItemGrouping::ByFullValue);
+    reportModel->insertList(reportItems());
+    page_->findChild<ListView *>("listView")->setDataModel(reportModel);
+
+    ActionItem *saveAction = ActionItem::create()
+        .title(tr("Save Data"))
+        .imageSource(QUrl("asset:///images/ic_save.png"))
+        .onTriggered(this, SLOT(onSaveData()))
+        .parent(this);
+    page_->addAction(saveAction, ActionBarPlacement::OnBar);
+}
+
+StatisticsPage::~StatisticsPage()
+{
+}
+
+void StatisticsPage::push(bb::cascades::NavigationPane *navPane)
+{
+    navPane->push(page_);
+}
+
+QVariantList StatisticsPage::reportItems() const
+{
+    QVariantList items;
+    int rank = 0;
+
+    const QString kindGroup = tr("Attribute kinds");
+    foreach(const NamedCount &count, sortedCounts(statistics_.kindCounts)) {
+        items.append(reportItem(kindGroup, rank++, count.first, QString(), count.second));
+    }
+
+    const QString subKindGroup = tr("Attribute sub-kinds");
+    foreach(const NamedCount &count, sortedCounts(statistics_.subKindCounts)) {
+        items.append(reportItem(subKindGroup, rank++, count.first, QString(), count.second));
+    }
+
+    const QString accountGroup = tr("Source accounts");
+    QList<int> accountIds = statistics_.accountContactCounts.keys();
+    qSort(accountIds);
+    foreach(int accountId, accountIds) {
+        const QString name = statistics_.accountNames.value(accountId);
+        items.append(reportItem(accountGroup, rank++,
+            name.isEmpty() ? tr("Account %1").arg(accountId) : name,
+            tr("%1 contacts, %2 attribute values")
+                .arg(statistics_.accountContactCounts.value(accountId))
+                .arg(statistics_.accountValueCounts.value(accountId)),
+            accountId));
+    }
+
+    const QString histogramGroup = tr("Attributes per contact");
+    for(QMap<int, qint64>::const_iterator it = statistics_.attributeHistogram.constBegin();
+        it != statistics_.attributeHistogram.constEnd(); ++it) {
+        const QString title = (it.key() == 0) ? tr("No attributes")
+            : tr("%1 to %2 attributes").arg(it.key()).arg(it.key() * 2 - 1);
+        items.append(reportItem(histogramGroup, rank++, title, QString(), it.value()));
+    }
+
+    // Contacts in the rankings can be opened from the report
+    const QString mostAttributesGroup = tr("Most attributes");
+    foreach(const ContactStatisticsEntry &entry, statistics_.mostAttributes) {
+        QVariantMap map = reportItem(mostAttributesGroup, rank++, entry.displayName,
+            tr("%1 attributes").arg(entry.attributeCount), entry.contactId);
+        map["contactId"] = entry.contactId;
+        items.append(map);
+    }
+
+    const QString largestGroup = tr("Largest contacts");
+    foreach(const ContactStatisticsEntry &entry, statistics_.largestContacts) {
+        QVariantMap map = reportItem(largestGroup, rank++, entry.displayName,
+            tr("%1 bytes").arg(entry.byteSize), entry.contactId);
+        map["contactId"] = entry.contactId;
+        items.append(map);
+    }
+    return items;
+}
+
+void StatisticsPage::onSaveData()
+{
+    pickers::FilePicker* filePicker = new pickers::FilePicker(this);
+    filePicker->setType(pickers::FileType::Other);
+    filePicker->setMode(pickers::FilePickerMode::Saver);
+    filePicker->setDefaultSaveFileNames(QStringList() << QLatin1String("statistics.json"));
+    connect(filePicker, SIGNAL(fileSelected(QStringList)), this, SLOT(onPickerFileSelected(QStringList)), Qt::QueuedConnection);
+    connect(filePicker, SIGNAL(canceled()), this, SLOT(onPickerCanceled()));
+    filePicker->open();
+}
+
+void StatisticsPage::onPickerFileSelected(const QStringList& selectedFiles)
+{
+    pickers::FilePicker *picker = qobject_cast<pickers::FilePicker*>(sender());
+    picker->deleteLater();
+    if(selectedFiles.length() < 1 || selectedFiles[0].isEmpty()) { return; }
+
+    QFile file(selectedFiles[0]);
+    bool saved = false;
+    if(file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        JsonWriter writer(&file, true);
+        statistics_.write(writer);
+        saved = writer.flush();
+        file.close();
+    }
+    if(saved) {
+        file.setPermissions(
+            QFile::ReadOwner | QFile::WriteOwner |
+            QFile::ReadGroup | QFile::WriteGroup |
+            QFile::ReadOther | QFile::WriteOther);
+    }
+    else {
+        qWarning() << "Unable to write file:" << file.errorString();
+    }
+
+    bb::system::SystemToast *toast = new bb::system::SystemToast(this);
+    connect(toast, SIGNAL(finished(bb::system::SystemUiResult::Type)), toast, SLOT(deleteLater()));
+    toast->setBody(saved ? tr("Statistics saved to file") : tr("Unable to save statistics"));
+    toast->show();
+}
+
+void StatisticsPage::onPickerCanceled()
+{
+    pickers::FilePicker *picker = qobject_cast<pickers::FilePicker*>(sender());
+    picker->deleteLater();
+}
@@ -0,0 +1,36 @@
+#ifndef STATISTICSPAGE_HPP
+#define STATISTICSPAGE_HPP
+
+#include <QtCore/QObject>
+
+#include "contactstatistics.hpp"
+
+namespace bb { namespace cascades {
+class Page;
+class NavigationPane;
+}}
+
+/**
+ * Report of the statistics collected over the whole contact database,
+ * which can also be saved as a JSON file.
+ */
+class StatisticsPage : public QObject
+{
+    Q_OBJECT
+public:
+    StatisticsPage(const ContactStatistics &statistics, QObject *parent=0);
+    virtual ~StatisticsPage();
+    void push(bb::cascades::NavigationPane *navPane);
+signals:
+    void openContact(int contactId);
+private slots:
+    void onSaveData();
+    void onPickerFileSelected(const QStringList& selectedFiles);
+    void onPickerCanceled();
+private:
+    QVariantList reportItems() const;
+    ContactStatistics statistics_;
+    bb::cascades::Page *page_;
+};
+
+#endif // STATISTICSPAGE_HPP
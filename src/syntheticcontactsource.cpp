@@ -0,0 +1,275 @@
+#include "syntheticcontactsource.hpp"
+
+#include <QtCore/QThread>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QList>
+
+namespace
+{
+const char *const firstNames[] = {
+    "Adam", "Alice", "Ana", "Ben", "Carlos", "Chloe", "Daniel", "Élodie", "Emma", "Fatima",
+    "George", "Hannah", "Hiroshi", "Isabel", "Jack", "Jörg", "Julia", "Kevin", "Laura", "Liam",
+    "María", "Mei", "Noah", "Olivia", "Omar", "Paul", "Priya", "Quentin", "Rachel", "Sam",
+    "Søren", "Sofia", "Thomas", "Uma", "Victor", "Wei", "Xavier", "Yuki", "Zoë", "Zach"
+};
+
+const char *const lastNames[] = {
+    "Anderson", "Baker", "Brown", "Chen", "Clark", "Davis", "Dubois", "Evans", "García", "Green",
+    "Hall", "Harris", "Ito", "Jackson", "Johnson", "Kim", "Lee", "López", "Martin", "Miller",
+    "Moore", "Müller", "Nguyen", "O'Brien", "Patel", "Quinn", "Robinson", "Rossi", "Schmidt", "Smith",
+    "Suzuki", "Taylor", "Thompson", "Walker", "White", "Williams", "Wilson", "Wright", "Young", "Zhang"
+};
+
+const char *const companyNames[] = {
+    "Acme Corp", "Globex", "Initech", "Umbrella", "Stark Industries", "Wayne Enterprises",
+    "Hooli", "Vandelay Industries", "Soylent", "Tyrell"
+};
+
+// Kinds and sub-kinds generated, with codes of their own
+struct KindEntry
+{
+    int kind;
+    const char *kindName;
+    int subKind;
+    const char *subKindName;
+};
+
+const KindEntry kindEntries[] = {
+    { 1, "Phone", 10, "Mobile" },
+    { 1, "Phone", 11, "Home" },
+    { 1, "Phone", 12, "Work" },
+    { 4, "Email", 20, "Home" },
+    { 4, "Email", 21, "Work" },
+    { 5, "Website", 30, "Blog" },
+    { 5, "Website", 31, "Personal" },
+    { 12, "Name", 40, "Title" },
+    { 12, "Name", 41, "Nickname" },
+    { 15, "OrganizationAffiliation", 50, "JobTitle" },
+    { 17, "Note", 60, "Other" },
+    { 18, "InstantMessaging", 70, "InstantMessagingBbmPin" },
+    { 18, "InstantMessaging", 71, "InstantMessagingSkype" },
+    { 10, "Date", 80, "Birthday" }
+};
+
+const int firstNameCount = sizeof(firstNames) / sizeof(firstNames[0]);
+const int lastNameCount = sizeof(lastNames) / sizeof(lastNames[0]);
+const int companyNameCount = sizeof(companyNames) / sizeof(companyNames[0]);
+const int kindEntryCount = sizeof(kindEntries) / sizeof(kindEntries[0]);
+
+enum Salt
+{
+    FirstNameSalt = 1,
+    LastNameSalt,
+    CompanySalt,
+    PhotoSalt,
+    AccountSalt,
+    AttributeCountSalt,
+    AttributeSalt
+};
+
+// QThread::msleep() is protected in Qt 4
+class Sleeper : public QThread
+{
+public:
+    static void sleep(int msecs)
+    {
+        if(msecs > 0) {
+            QThread::msleep(msecs);
+        }
+    }
+};
+
+QString photoFilepath(int contactId)
+{
+    return QString("/tmp/contactsinspector-synthetic/photo-%1.jpg").arg(contactId);
+}
+}
+
+SyntheticContactSource::SyntheticContactSource(const SyntheticContactOptions &options)
+    : options_(options)
+{
+    entries_.reserve(options_.contactCount);
+    for(int contactId = 1; contactId <= options_.contactCount; contactId++) {
+        const QString firstName = QString::fromUtf8(firstNames[random(contactId, FirstNameSalt) % firstNameCount]);
+        const QString lastName = QString::fromUtf8(lastNames[random(contactId, LastNameSalt) % lastNameCount]);
+
+        ContactListEntry entry;
+        entry.contactId = contactId;
+        entry.displayName = firstName + QLatin1Char(' ') + lastName;
+        if(random(contactId, CompanySalt) % 3 == 0) {
+            entry.displayCompanyName = QString::fromUtf8(companyNames[random(contactId, CompanySalt) / 3 % companyNameCount]);
+        }
+        if(int(random(contactId, PhotoSalt) % 100) < options_.photoPercent) {
+            entry.photoFilepath = photoFilepath(contactId);
+        }
+        entries_.append(entry);
+    }
+
+    qSort(entries_.begin(), entries_.end(), entryLessThan);
+    positions_.reserve(entries_.size());
+    for(int i = 0; i < entries_.size(); i++) {
+        positions_.insert(entries_[i].contactId, i);
+    }
+
+    accountEntries_.resize(qMax(0, options_.accountCount));
+    accountPositions_.resize(accountEntries_.size());
+    foreach(const ContactListEntry &entry, entries_) {
+        foreach(int accountId, accountIds(entry.contactId)) {
+            accountPositions_[accountId - 1].insert(entry.contactId, accountEntries_[accountId - 1].size());
+            accountEntries_[accountId - 1].append(entry);
+        }
+    }
+}
+
+SyntheticContactSource::~SyntheticContactSource()
+{
+}
+
+QVector<ContactListEntry> SyntheticContactSource::listEntries(int anchorContactId, int limit)
+{
+    Sleeper::sleep(options_.listLatencyMsecs);
+    return listPage(entries_, positions_, anchorContactId, limit);
+}
+
+QList<int> SyntheticContactSource::partitions()
+{
+    QList<int> partitions;
+    for(int accountId = 1; accountId <= accountEntries_.size(); accountId++) {
+        partitions.append(accountId);
+    }
+    return partitions;
+}
+
+QVector<ContactListEntry> SyntheticContactSource::listPartitionEntries(int partition, int anchorContactId, int limit)
+{
+    Sleeper::sleep(options_.listLatencyMsecs);
+    if(partition < 1 || partition > accountEntries_.size()) {
+        return QVector<ContactListEntry>();
+    }
+    return listPage(accountEntries_[partition - 1], accountPositions_[partition - 1], anchorContactId, limit);
+}
+
+QVector<ContactListEntry> SyntheticContactSource::listPage(const QVector<ContactListEntry> &entries,
+    const QHash<int, int> &positions, int anchorContactId, int limit)
+{
+    int first = 0;
+    if(anchorContactId != 0) {
+        first = positions.value(anchorContactId, entries.size() - 1) + 1;
+    }
+    const int count = qMax(0, qMin(limit, entries.size() - first));
+    return entries.mid(first, count);
+}
+
+ContactRecord SyntheticContactSource::contactDetails(int contactId)
+{
+    Sleeper::sleep(options_.detailsLatencyMsecs);
+
+    const int position = positions_.value(contactId, -1);
+    if(position < 0) {
+        return ContactRecord();
+    }
+    const ContactListEntry &entry = entries_[position];
+
+    ContactRecord record;
+    record.id = contactId;
+    record.accountId = 1 + random(contactId, AccountSalt) % qMax(1, options_.accountCount);
+    record.displayName = entry.displayName;
+    record.displayCompanyName = entry.displayCompanyName;
+    record.firstName = entry.displayName.section(QLatin1Char(' '), 0, 0);
+    record.lastName = entry.displayName.section(QLatin1Char(' '), 1);
+    record.smallPhotoFilepath = entry.photoFilepath;
+
+    foreach(int accountId, accountIds(contactId)) {
+        ContactRecordAccount account;
+        account.id = accountId;
+        account.displayName = QString("Account %1").arg(account.id);
+        account.providerId = QString("com.example.provider%1").arg(account.id);
+        account.providerName = QString("Provider %1").arg(account.id);
+        record.sourceAccounts.append(account);
+    }
+
+    if(!entry.photoFilepath.isEmpty()) {
+        for(int i = 0; i < record.sourceAccounts.size(); i++) {
+            ContactRecordPhoto photo;
+            photo.id = contactId * 10 + i;
+            photo.sourceAccountId = record.sourceAccounts[i].id;
+            photo.smallPhotoFilepath = entry.photoFilepath;
+            record.photos.append(photo);
+        }
+        if(!record.photos.isEmpty()) {
+            record.primaryPhotoId = record.photos.first().id;
+        }
+    }
+
+    const int attributeRange = qMax(0, options_.maximumAttributes - options_.minimumAttributes);
+    const int attributeCount = options_.minimumAttributes
+        + int(random(contactId, AttributeCountSalt) % (attributeRange + 1));
+    const QString emailName = record.firstName.toLower() + QLatin1Char('.') + record.lastName.toLower();
+    for(int i = 0; i < attributeCount; i++) {
+        const quint32 value = random(contactId, AttributeSalt + i);
+        const KindEntry &kindEntry = kindEntries[value % kindEntryCount];
+
+        ContactRecordAttribute attribute;
+        attribute.id = contactId * 100 + i;
+        attribute.kind = kindEntry.kind;
+        attribute.subKind = kindEntry.subKind;
+        attribute.kindName = QLatin1String(kindEntry.kindName);
+        attribute.subKindName = QLatin1String(kindEntry.subKindName);
+        attribute.label = attribute.subKindName;
+        if(!record.sourceAccounts.isEmpty()) {
+            attribute.sources.append(record.sourceAccounts[i % record.sourceAccounts.size()].id);
+        }
+
+        switch(kindEntry.kind) {
+        case 1:
+            attribute.value = QString("+1 555 %1").arg(value % 10000000, 7, 10, QLatin1Char('0'));
+            record.phoneNumbers.append(attribute);
+            break;
+        case 4:
+            attribute.value = QString("%1%2@example.com").arg(emailName).arg(i);
+            record.emails.append(attribute);
+            break;
+        case 5:
+            attribute.value = QString("http://www.example.com/%1").arg(value % 100000);
+            break;
+        case 10:
+            attribute.value = QString("19%1-%2-%3").arg(50 + value % 50)
+                .arg(1 + value / 50 % 12, 2, 10, QLatin1Char('0'))
+                .arg(1 + value / 600 % 28, 2, 10, QLatin1Char('0'));
+            break;
+        default:
+            attribute.value = QString("%1 %2").arg(QLatin1String(kindEntry.subKindName)).arg(value % 100000);
+            break;
+        }
+        record.attributes.append(attribute);
+    }
+    return record;
+}
+
+QList<int> SyntheticContactSource::accountIds(int contactId) const
+{
+    QList<int> accountIds;
+    if(options_.accountCount <= 0) { return accountIds; }
+
+    // Contacts appearing through more than one account are the ones the
+    // inspector is most often used for, so every fourth one does.
+    const int firstAccountId = 1 + random(contactId, AccountSalt) % options_.accountCount;
+    const int accountCount = (random(contactId, AccountSalt) % 4 == 0) ? 2 : 1;
+    for(int i = 0; i < accountCount && i < options_.accountCount; i++) {
+        accountIds.append(1 + (firstAccountId - 1 + i) % options_.accountCount);
+    }
+    return accountIds;
+}
+
+quint32 SyntheticContactSource::random(int contactId, quint32 salt) const
+{
+    // Integer hash, so any field of any contact can be generated on its
+    // own without generating the contacts before it.
+    quint32 x = quint32(contactId) * 0x9E3779B1u ^ (options_.seed + salt * 0x85EBCA77u);
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
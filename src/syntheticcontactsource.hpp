@@ -0,0 +1,65 @@
+#ifndef SYNTHETICCONTACTSOURCE_HPP
+#define SYNTHETICCONTACTSOURCE_HPP
+
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+
+#include "contactsource.hpp"
+
+struct SyntheticContactOptions
+{
+    SyntheticContactOptions() : contactCount(1000), minimumAttributes(4), maximumAttributes(16),
+        photoPercent(30), accountCount(3), listLatencyMsecs(0), detailsLatencyMsecs(0), seed(1) { }
+    int contactCount;
+    int minimumAttributes;
+    int maximumAttributes;
+    int photoPercent;
+    int accountCount;
+    int listLatencyMsecs;
+    int detailsLatencyMsecs;
+    quint32 seed;
+};
+
+/**
+ * Contact source generating contacts instead of reading them, for
+ * measuring the application on databases of any size.
+ *
+ * The same options always produce the same contacts. List entries are
+ * generated up front, while the details of a contact are generated from
+ * its ID whenever they are asked for. Each call can be made to take a
+ * fixed extra time, to stand in for the latency of a real service.
+ *
+ * Like the device service, contacts are partitioned by their source
+ * accounts.
+ */
+class SyntheticContactSource : public ContactSource
+{
+public:
+    SyntheticContactSource(const SyntheticContactOptions &options);
+    virtual ~SyntheticContactSource();
+
+    virtual QVector<ContactListEntry> listEntries(int anchorContactId, int limit);
+    virtual QList<int> partitions();
+    virtual QVector<ContactListEntry> listPartitionEntries(int partition, int anchorContactId, int limit);
+    virtual ContactRecord contactDetails(int contactId);
+
+    int size() const { return entries_.size(); }
+
+    /**
+     * Returns the list entry at a position in display order.
+     */
+    const ContactListEntry &entry(int index) const { return entries_[index]; }
+
+private:
+    static QVector<ContactListEntry> listPage(const QVector<ContactListEntry> &entries,
+        const QHash<int, int> &positions, int anchorContactId, int limit);
+    QList<int> accountIds(int contactId) const;
+    quint32 random(int contactId, quint32 salt) const;
+    SyntheticContactOptions options_;
+    QVector<ContactListEntry> entries_;
+    QHash<int, int> positions_;
+    QVector<QVector<ContactListEntry> > accountEntries_;
+    QVector<QHash<int, int> > accountPositions_;
+};
+
+#endif // SYNTHETICCONTACTSOURCE_HPP
@@ -0,0 +1,203 @@
+#include "trace.hpp"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/QtAlgorithms>
+
+#include "jsonwriter.hpp"
+
+namespace
+{
+// Must be a power of two
+const int TraceCapacity = 32768;
+
+struct TraceEvent
+{
+    const char *category;
+    const char *name;
+    qint64 timestamp;
+    qint64 duration;
+    qint64 value;
+    Qt::HANDLE thread;
+    char phase;
+};
+
+struct TraceSlot
+{
+    // Zero while the slot is empty, -1 while a writer holds it, and
+    // otherwise the position of the event it holds plus one.
+    QAtomicInt sequence;
+    TraceEvent event;
+};
+
+struct TraceBuffer
+{
+    TraceBuffer() : next(0), entries(new TraceSlot[TraceCapacity])
+    {
+        clock.start();
+    }
+    ~TraceBuffer()
+    {
+        delete[] entries;
+    }
+    QElapsedTimer clock;
+    QAtomicInt next;
+    TraceSlot *entries;
+};
+
+// Only allocated once tracing is first enabled
+Q_GLOBAL_STATIC(TraceBuffer, traceBuffer)
+
+void record(const TraceEvent &event)
+{
+    TraceBuffer *buffer = traceBuffer();
+    const int position = buffer->next.fetchAndAddRelaxed(1);
+    TraceSlot &slot = buffer->entries[position & (TraceCapacity - 1)];
+
+    // A writer that laps the buffer while another still holds the slot
+    // drops its event rather than writing over one being written.
+    const int sequence = slot.sequence;
+    if(sequence == -1 || !slot.sequence.testAndSetAcquire(sequence, -1)) {
+        return;
+    }
+    slot.event = event;
+    slot.sequence.fetchAndStoreRelease(position + 1);
+}
+
+bool timestampLessThan(const TraceEvent &event1, const TraceEvent &event2)
+{
+    return event1.timestamp < event2.timestamp;
+}
+}
+
+volatile bool Trace::enabled_ = false;
+
+void Trace::setEnabled(bool enabled)
+{
+    if(enabled && !enabled_) {
+        TraceBuffer *buffer = traceBuffer();
+        for(int i = 0; i < TraceCapacity; i++) {
+            buffer->entries[i].sequence.fetchAndStoreRelaxed(0);
+        }
+        buffer->next.fetchAndStoreRelease(0);
+    }
+    enabled_ = enabled;
+}
+
+qint64 Trace::now()
+{
+    return traceBuffer()->clock.nsecsElapsed();
+}
+
+void Trace::complete(const char *category, const char *name, qint64 startNsecs, qint64 durationNsecs)
+{
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.timestamp = startNsecs;
+    event.duration = durationNsecs;
+    event.value = 0;
+    event.thread = QThread::currentThreadId();
+    event.phase = 'X';
+    record(event);
+}
+
+void Trace::counter(const char *category, const char *name, qint64 value)
+{
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.timestamp = now();
+    event.duration = 0;
+    event.value = value;
+    event.thread = QThread::currentThreadId();
+    event.phase = 'C';
+    record(event);
+}
+
+void Trace::instant(const char *category, const char *name)
+{
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.timestamp = now();
+    event.duration = 0;
+    event.value = 0;
+    event.thread = QThread::currentThreadId();
+    event.phase = 'i';
+    record(event);
+}
+
+bool Trace::writeChromeTrace(QIODevice *device)
+{
+    // Copy out every slot holding a complete event, skipping any that are
+    // rewritten while being copied.
+    QVector<TraceEvent> events;
+    TraceBuffer *buffer = traceBuffer();
+    events.reserve(TraceCapacity);
+    for(int i = 0; i < TraceCapacity; i++) {
+        TraceSlot &slot = buffer->entries[i];
+        const int sequence = slot.sequence.fetchAndAddAcquire(0);
+        if(sequence <= 0) { continue; }
+        const TraceEvent event = slot.event;
+
+        // The full barrier keeps the copy from being reordered after the
+        // second read of the sequence
+        if(slot.sequence.fetchAndAddOrdered(0) == sequence) {
+            events.append(event);
+        }
+    }
+    qSort(events.begin(), events.end(), timestampLessThan);
+
+    // Threads are numbered in the order they first appear
+    QHash<Qt::HANDLE, int> threadIds;
+
+    JsonWriter writer(device);
+    writer.beginObject();
+    writer.writeName("traceEvents");
+    writer.beginArray();
+    foreach(const TraceEvent &event, events) {
+        QHash<Qt::HANDLE, int>::const_iterator it = threadIds.constFind(event.thread);
+        if(it == threadIds.constEnd()) {
+            it = threadIds.insert(event.thread, threadIds.size() + 1);
+        }
+
+        writer.beginObject();
+        writer.writeName("name");
+        writer.writeString(QLatin1String(event.name));
+        writer.writeName("cat");
+        writer.writeString(QLatin1String(event.category));
+        writer.writeName("ph");
+        writer.writeString(QString(QLatin1Char(event.phase)));
+        writer.writeName("ts");
+        writer.writeDouble(event.timestamp / 1000.0);
+        if(event.phase == 'X') {
+            writer.writeName("dur");
+            writer.writeDouble(event.duration / 1000.0);
+        }
+        else if(event.phase == 'i') {
+            writer.writeName("s");
+            writer.writeString(QLatin1String("t"));
+        }
+        writer.writeName("pid");
+        writer.writeNumber(1);
+        writer.writeName("tid");
+        writer.writeNumber(it.value());
+        if(event.phase == 'C') {
+            writer.writeName("args");
+            writer.beginObject();
+            writer.writeName(QLatin1String(event.name));
+            writer.writeNumber(event.value);
+            writer.endObject();
+        }
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.writeName("displayTimeUnit");
+    writer.writeString(QLatin1String("ms"));
+    writer.endObject();
+    return writer.flush();
+}
@@ -0,0 +1,78 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <QtCore/QtGlobal>
+
+class QIODevice;
+
+/**
+ * Lightweight event tracing for the loading and display paths.
+ *
+ * Events are recorded into a fixed size ring buffer shared by all threads,
+ * without taking any locks, and the most recent ones can be written out in
+ * the Chrome trace event format for viewing in chrome://tracing. Names and
+ * categories must be string literals, as only the pointers are stored.
+ *
+ * Tracing is off until enabled, and while it is off recording an event
+ * costs a single check of a flag. Defining NO_TRACE removes the trace
+ * macros from the build entirely.
+ */
+class Trace
+{
+public:
+    static bool isEnabled() { return enabled_; }
+
+    /**
+     * Turns recording on or off. Enabling tracing discards any events
+     * recorded previously.
+     */
+    static void setEnabled(bool enabled);
+
+    static qint64 now();
+    static void complete(const char *category, const char *name, qint64 startNsecs, qint64 durationNsecs);
+    static void counter(const char *category, const char *name, qint64 value);
+    static void instant(const char *category, const char *name);
+
+    static bool writeChromeTrace(QIODevice *device);
+
+private:
+    static volatile bool enabled_;
+};
+
+/**
+ * Records the time spent in a scope as a single complete event.
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const char *name)
+        : category_(category), name_(name), start_(Trace::isEnabled() ? Trace::now() : -1) { }
+    ~TraceScope()
+    {
+        if(start_ >= 0) {
+            Trace::complete(category_, name_, start_, Trace::now() - start_);
+        }
+    }
+private:
+    Q_DISABLE_COPY(TraceScope)
+    const char *category_;
+    const char *name_;
+    qint64 start_;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifndef NO_TRACE
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+#define TRACE_COUNTER(category, name, value) \
+    do { if(Trace::isEnabled()) { Trace::counter(category, name, value); } } while(0)
+#define TRACE_INSTANT(category, name) \
+    do { if(Trace::isEnabled()) { Trace::instant(category, name); } } while(0)
+#else
+#define TRACE_SCOPE(category, name) do { } while(0)
+#define TRACE_COUNTER(category, name, value) do { } while(0)
+#define TRACE_INSTANT(category, name) do { } while(0)
+#endif
+
+#endif // TRACE_HPP